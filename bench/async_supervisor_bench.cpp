@@ -0,0 +1,60 @@
+// 单线程协程引擎监控大量模块：同时杀掉全部模块，测量全部重启完成的时间
+// 各模块的退避定时器并行计时，总耗时约为 restart_delay + 重新拉起进程的开销
+#include "process_manager/async_process_manager.h"
+#include <signal.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <async_simple/coro/SyncAwait.h>
+#include "ylt/easylog.hpp"
+
+using namespace std::chrono;
+
+int main(int argc, char** argv) {
+    int module_count = argc > 1 ? std::atoi(argv[1]) : 1000;
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+
+    asio::io_context io;
+    auto guard = asio::make_work_guard(io);
+    std::thread io_thread([&] { io.run(); });
+
+    ProcessManager::AsyncProcessManager pm(io.get_executor(), milliseconds(200));
+    for (int i = 0; i < module_count; ++i) {
+        pm.addModule("m" + std::to_string(i), "sleep 1000", true);
+    }
+
+    auto t0 = steady_clock::now();
+    for (int i = 0; i < module_count; ++i) {
+        async_simple::coro::syncAwait(pm.start("m" + std::to_string(i)));
+    }
+    auto t1 = steady_clock::now();
+    std::printf("started %d modules on one thread in %.1f ms\n", module_count,
+                duration<double, std::milli>(t1 - t0).count());
+
+    for (const auto& info : pm.getAllProcesses()) {
+        kill(info.pid, SIGKILL);
+    }
+    auto t2 = steady_clock::now();
+    for (;;) {
+        int running = 0;
+        for (const auto& info : pm.getAllProcesses()) {
+            running += info.state == ProcessManager::ProcessState::RUNNING && info.restart_count == 1;
+        }
+        if (running == module_count) {
+            break;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    auto t3 = steady_clock::now();
+    std::printf("all %d modules restarted %.1f ms after SIGKILL (restart_delay 200 ms)\n", module_count,
+                duration<double, std::milli>(t3 - t2).count());
+
+    async_simple::coro::syncAwait(pm.shutdown(milliseconds(500)));
+    std::printf("shutdown in %.1f ms\n", duration<double, std::milli>(steady_clock::now() - t3).count());
+
+    guard.reset();
+    io.stop();
+    io_thread.join();
+    return 0;
+}
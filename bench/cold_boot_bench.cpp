@@ -0,0 +1,75 @@
+// 冷启动：注册N个模块（默认1000个 sleep 60），测量从发起启动到全部进入RUNNING的耗时。
+// 对比逐个startModule、startAll（1个/多个启动线程）以及经由zygote的startAll
+#include "process_manager/process_manager.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "ylt/easylog.hpp"
+
+using namespace std::chrono;
+using ProcessManager::LaunchBackend;
+
+enum class Mode { SERIAL, BATCH };
+
+static double coldBoot(int modules, Mode mode, LaunchBackend backend, size_t threads, bool zygote) {
+    ProcessManager::SupervisorOptions options;
+    options.mode = ProcessManager::SupervisorMode::EVENT;
+    options.handle_signals = false;
+    options.launch_backend = backend;
+    options.launch_threads = threads;
+    options.use_zygote = zygote;
+    ProcessManager::ProcessManager pm(options);
+
+    std::vector<std::string> names;
+    names.reserve(modules);
+    for (int i = 0; i < modules; ++i) {
+        names.push_back("m" + std::to_string(i));
+        pm.addModule(names.back(), "/bin/sleep 60", false);
+    }
+
+    auto t0 = steady_clock::now();
+    size_t started = 0;
+    if (mode == Mode::SERIAL) {
+        for (const auto& name : names) {
+            started += pm.startModule(name) ? 1 : 0;
+        }
+    } else {
+        for (const auto& result : pm.startAll()) {
+            started += result.started ? 1 : 0;
+        }
+    }
+    double ms = duration<double, std::milli>(steady_clock::now() - t0).count();
+    if (started != names.size()) {
+        std::printf("  only %zu of %zu modules started\n", started, names.size());
+    }
+    pm.shutdown();
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    int modules = argc > 1 ? std::atoi(argv[1]) : 1000;
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+
+    const struct {
+        const char* name;
+        Mode mode;
+        LaunchBackend backend;
+        size_t threads;
+        bool zygote;
+    } cases[] = {
+        {"serial startModule (fork)", Mode::SERIAL, LaunchBackend::FORK, 1, false},
+        {"startAll x1 (fork)", Mode::BATCH, LaunchBackend::FORK, 1, false},
+        {"startAll x4 (fork)", Mode::BATCH, LaunchBackend::FORK, 4, false},
+        {"serial startModule (vfork)", Mode::SERIAL, LaunchBackend::VFORK, 1, false},
+        {"startAll x4 (vfork)", Mode::BATCH, LaunchBackend::VFORK, 4, false},
+        {"startAll (zygote)", Mode::BATCH, LaunchBackend::VFORK, 1, true},
+    };
+
+    std::printf("cold boot of %d modules\n", modules);
+    for (const auto& c : cases) {
+        std::printf("%-28s %10.1f ms\n", c.name, coldBoot(modules, c.mode, c.backend, c.threads, c.zygote));
+    }
+    return 0;
+}
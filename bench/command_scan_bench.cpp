@@ -0,0 +1,173 @@
+// 命令分类：对比原来的needsShell（每次构造15个运算符、逐个子串查找）与单遍的字符类别扫描，
+// 统计语料中的误判（本可直接exec却被交给bash）。--fuzz N 对语料做N次随机变异，
+// 把判定为可直接exec的命令与bash的分词结果（printf '%s\0' <命令>）逐一比较
+#include "process_manager/command_parser.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+#ifndef COMMAND_CORPUS
+#define COMMAND_CORPUS "bench/command_corpus.txt"
+#endif
+
+// 原来的实现
+static bool legacyNeedsShell(const std::string& command) {
+    const std::vector<std::string> shell_operators = {
+        "&&", "||", ";", "|", ">", "<", ">>", "<<",
+        "source", "export", "cd", "$", "`", "$(", ")"
+    };
+    for (const auto& op : shell_operators) {
+        if (command.find(op) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// bash对 printf '%s\0' <命令> 的分词结果
+static bool bashWords(const std::string& command, std::vector<std::string>& words) {
+    int out[2];
+    if (pipe(out) == -1) {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(out[1], STDOUT_FILENO);
+        close(out[0]);
+        close(out[1]);
+        std::string script = "printf '%s\\0' " + command;
+        execl("/bin/bash", "bash", "-c", script.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    close(out[1]);
+    std::string output;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(out[0], buf, sizeof(buf))) > 0) {
+        output.append(buf, n);
+    }
+    close(out[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    words.clear();
+    for (size_t begin = 0; begin < output.size();) {
+        size_t end = output.find('\0', begin);
+        words.push_back(output.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static int fuzz(const std::vector<std::string>& corpus, int iterations) {
+    static const char kAlphabet[] = " \t;&|<>()$`'\"\\*?[]{}#~=!-/.:_aZ09\n";
+    std::mt19937 rng(12345);
+    int plain = 0, mismatches = 0;
+    for (int i = 0; i < iterations; ++i) {
+        std::string command = corpus[rng() % corpus.size()];
+        for (int edits = 1 + rng() % 3; edits > 0; --edits) {
+            size_t pos = command.empty() ? 0 : rng() % (command.size() + 1);
+            char c = kAlphabet[rng() % (sizeof(kAlphabet) - 1)];
+            switch (rng() % 3) {
+                case 0: command.insert(pos, 1, c); break;
+                case 1: if (pos < command.size()) command.erase(pos, 1); break;
+                default: if (pos < command.size()) command[pos] = c; break;
+            }
+        }
+        auto scan = ProcessManager::CommandParser::scan(command);
+        if (scan.needs_shell || scan.args.empty()) {
+            continue;
+        }
+        ++plain;
+        std::vector<std::string> words;
+        if (!bashWords(command, words) || words != scan.args) {
+            ++mismatches;
+            std::printf("mismatch: [%s]\n", command.c_str());
+        }
+    }
+    std::printf("fuzz: %d mutations, %d classified as plain, %d mismatches against bash\n", iterations, plain,
+                mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+template <typename F>
+static double nsPerCommand(const std::vector<std::string>& corpus, int rounds, F&& classify) {
+    size_t shell = 0;
+    auto t0 = steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& command : corpus) {
+            shell += classify(command);
+        }
+    }
+    double ns = duration<double, std::nano>(steady_clock::now() - t0).count();
+    if (shell == static_cast<size_t>(-1)) {
+        std::printf("\n");   // 防止被优化掉
+    }
+    return ns / (static_cast<double>(rounds) * corpus.size());
+}
+
+int main(int argc, char** argv) {
+    std::string corpus_file = COMMAND_CORPUS;
+    int fuzz_iterations = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--fuzz") == 0 && i + 1 < argc) {
+            fuzz_iterations = std::atoi(argv[++i]);
+        } else {
+            corpus_file = argv[i];
+        }
+    }
+    std::vector<std::string> corpus;
+    std::ifstream in(corpus_file);
+    for (std::string line; std::getline(in, line);) {
+        if (!line.empty()) {
+            corpus.push_back(line);
+        }
+    }
+    if (corpus.empty()) {
+        std::fprintf(stderr, "empty corpus: %s\n", corpus_file.c_str());
+        return 1;
+    }
+
+    // 误判：旧实现认为需要shell，bash的分词结果却与新实现给出的argv相同
+    int legacy_shell = 0, scan_shell = 0, false_positives = 0, mismatches = 0;
+    for (const auto& command : corpus) {
+        bool legacy = legacyNeedsShell(command);
+        auto scan = ProcessManager::CommandParser::scan(command);
+        legacy_shell += legacy;
+        scan_shell += scan.needs_shell;
+        if (!scan.needs_shell) {
+            std::vector<std::string> words;
+            if (!bashWords(command, words) || words != scan.args) {
+                ++mismatches;
+                std::printf("mismatch: [%s]\n", command.c_str());
+            } else if (legacy) {
+                ++false_positives;
+            }
+        }
+    }
+    std::printf("%zu commands: legacy needsShell %d, scan %d (%d legacy false positives, %d mismatches)\n",
+                corpus.size(), legacy_shell, scan_shell, false_positives, mismatches);
+
+    constexpr int kRounds = 20000;
+    std::printf("%-24s %8.1f ns/command\n", "legacy needsShell",
+                nsPerCommand(corpus, kRounds, legacyNeedsShell));
+    std::printf("%-24s %8.1f ns/command\n", "needsShell",
+                nsPerCommand(corpus, kRounds, ProcessManager::CommandParser::needsShell));
+    std::printf("%-24s %8.1f ns/command\n", "scan (verdict + argv)", nsPerCommand(corpus, kRounds, [](const std::string& c) {
+                    return ProcessManager::CommandParser::scan(c).needs_shell;
+                }));
+
+    int status = mismatches == 0 ? 0 : 1;
+    if (fuzz_iterations > 0) {
+        status |= fuzz(corpus, fuzz_iterations);
+    }
+    return status;
+}
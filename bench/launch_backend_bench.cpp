@@ -0,0 +1,92 @@
+// 各启动后端的启动延迟与父进程RSS的关系：父进程依次占用0、256、1024MB已触碰的内存，
+// 每个后端启动 /bin/true 若干次，只测量launch()调用本身（不含等待退出）。
+// zygote在占用内存之前启动，它的启动延迟不随父进程RSS变化
+#include "process_manager/process_launcher.h"
+#include "process_manager/launch_plan.h"
+#include "process_manager/zygote.h"
+#include <sys/wait.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "ylt/easylog.hpp"
+
+using namespace std::chrono;
+using ProcessManager::LaunchBackend;
+
+static long currentRssKb() {
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    long pages = 0, resident = 0;
+    if (f) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static double measure(LaunchBackend backend, ProcessManager::Zygote* zygote, int iterations) {
+    ProcessManager::LaunchOptions options;
+    options.backend = backend;
+    auto plan = ProcessManager::LaunchPlan::build({"/bin/true"});
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        int pidfd = -1;
+        auto t0 = steady_clock::now();
+        auto pid = zygote ? zygote->launch(*plan, &pidfd)
+                          : ProcessManager::ProcessLauncher::launch(*plan, options, &pidfd);
+        samples.push_back(duration<double, std::micro>(steady_clock::now() - t0).count());
+        if (pid) {
+            waitpid(*pid, nullptr, 0);
+        }
+        if (pidfd != -1) {
+            close(pidfd);
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+    ProcessManager::Zygote zygote;
+    if (!zygote.start()) {
+        std::printf("zygote unavailable\n");
+        return 1;
+    }
+
+    const struct {
+        LaunchBackend backend;
+        const char* name;
+    } backends[] = {
+        {LaunchBackend::FORK, "fork"},
+        {LaunchBackend::POSIX_SPAWN, "posix_spawn"},
+        {LaunchBackend::VFORK, "vfork"},
+        {LaunchBackend::CLONE3, "clone3"},
+    };
+
+    std::vector<std::unique_ptr<char[]>> ballast;
+    std::printf("%10s %12s %12s %12s %12s %12s   (p50 launch latency, us)\n", "parent RSS", "fork",
+                "posix_spawn", "vfork", "clone3", "zygote");
+    for (size_t extra_mb : {0, 256, 1024}) {
+        if (extra_mb > 0) {
+            size_t bytes = extra_mb * 1024 * 1024;
+            ballast.emplace_back(new char[bytes]);
+            std::memset(ballast.back().get(), 1, bytes);  // 触碰每一页，计入RSS
+        }
+        std::printf("%8ldMB", currentRssKb() / 1024);
+        for (const auto& b : backends) {
+            std::printf(" %12.1f", measure(b.backend, nullptr, iterations));
+        }
+        std::printf(" %12.1f", measure(LaunchBackend::CLONE3, &zygote, iterations));
+        std::printf("\n");
+    }
+    return 0;
+}
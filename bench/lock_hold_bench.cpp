@@ -0,0 +1,89 @@
+// 管理器锁的持有时间：100个模块不断被SIGKILL并立即重启（日志写入文件），
+// 开启lock_stats统计每次持有锁的时间，输出分布。第二轮同时有状态查询线程
+#include "process_manager/process_manager.h"
+#include <signal.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+void run(int modules, int kills, bool query) {
+    ProcessManager::SupervisorOptions options;
+    options.mode = ProcessManager::SupervisorMode::EVENT;
+    options.handle_signals = false;
+    options.restart_delay = milliseconds(0);
+    options.launch_backend = ProcessManager::LaunchBackend::VFORK;
+    options.lock_stats = true;
+    ProcessManager::ProcessManager pm(options);
+    std::vector<ProcessManager::ModuleId> ids;
+    for (int i = 0; i < modules; ++i) {
+        std::string name = "m" + std::to_string(i);
+        pm.addModule(name, "sleep 1000", true);
+        ids.push_back(pm.findModule(name));
+    }
+    pm.startAll();
+
+    std::atomic<bool> stop{false};
+    std::thread loop([&] {
+        while (!stop) {
+            pm.runOnce(100);
+        }
+    });
+    std::thread scraper([&] {
+        while (query && !stop) {
+            pm.getModuleState(ids[0]);
+            pm.snapshot();
+            std::this_thread::sleep_for(microseconds(100));
+        }
+    });
+
+    // 只统计崩溃、重启阶段
+    pm.resetLockStats();
+    std::mt19937 rng(7);
+    for (int i = 0; i < kills; ++i) {
+        auto snapshot = pm.snapshot();
+        const auto* info = snapshot->find(ids[rng() % ids.size()]);
+        if (info && info->state == ProcessManager::ProcessState::RUNNING) {
+            kill(info->pid, SIGKILL);
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    std::this_thread::sleep_for(milliseconds(100));
+    ProcessManager::LockStats stats = pm.lockStats();
+
+    stop = true;
+    loop.join();
+    scraper.join();
+    pm.shutdown();
+
+    std::printf("%s: %d kills, %lu lock acquisitions, mean %.0f ns, p50 < %lu ns, p99 < %lu ns, "
+                "p99.9 < %lu ns, max %lu ns\n",
+                query ? "crash loop + queries" : "crash loop", kills, stats.acquisitions,
+                stats.acquisitions ? double(stats.total_ns) / stats.acquisitions : 0.0, stats.percentileNs(0.5),
+                stats.percentileNs(0.99), stats.percentileNs(0.999), stats.max_ns);
+    for (int i = 0; i < ProcessManager::LockStats::kBuckets; ++i) {
+        if (stats.buckets[i] > 0) {
+            std::printf("    < %8lu ns  %8lu\n", ProcessManager::LockStats::bucketUpperNs(i), stats.buckets[i]);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int modules = argc > 1 ? std::atoi(argv[1]) : 100;
+    int kills = argc > 2 ? std::atoi(argv[2]) : 2000;
+    // 生命周期日志照常输出（写文件），但在锁外由事件消费者格式化
+    easylog::init_log(easylog::Severity::INFO, "/tmp/lock_hold_bench.log", false, false);
+    run(modules, kills, false);
+    run(modules, kills, true);
+    return 0;
+}
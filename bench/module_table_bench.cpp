@@ -0,0 +1,116 @@
+// 模块表的遍历与查找开销：100k个模块时，对比按名字索引的unordered_map<string, ProcessInfo>
+// （原来的存放方式）与分代slot map（连续存放，按句柄查找），
+// 以及ProcessManager按名字/按句柄查询状态和getAllProcesses的耗时
+#include "process_manager/process_manager.h"
+#include "process_manager/slot_map.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ylt/easylog.hpp"
+
+using namespace std::chrono;
+
+template <typename F>
+static double nsPerOp(size_t ops, F&& f) {
+    auto t0 = steady_clock::now();
+    f();
+    return duration<double, std::nano>(steady_clock::now() - t0).count() / ops;
+}
+
+static void report(const char* what, double ns) {
+    std::printf("%-40s %10.1f ns\n", what, ns);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+
+    std::vector<std::string> names(count);
+    for (size_t i = 0; i < count; ++i) {
+        names[i] = "module-" + std::to_string(i);
+    }
+    // 随机访问顺序，避免按插入顺序访问时的缓存优势
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    std::unordered_map<std::string, ProcessManager::ProcessInfo> by_name;
+    ProcessManager::SlotMap<ProcessManager::ProcessInfo> slots;
+    std::unordered_map<std::string, ProcessManager::ModuleId> ids;
+    std::vector<ProcessManager::ModuleId> handles(count);
+    for (size_t i = 0; i < count; ++i) {
+        ProcessManager::ProcessInfo info;
+        info.name = names[i];
+        info.command = "sleep 1";
+        info.restart_count = static_cast<int>(i & 7);
+        by_name[names[i]] = info;
+        handles[i] = slots.insert(info);
+        ids[names[i]] = handles[i];
+    }
+    std::printf("%zu modules, sizeof(ProcessInfo) = %zu\n", count, sizeof(ProcessManager::ProcessInfo));
+
+    long sum = 0;
+    report("iterate unordered_map (per module)", nsPerOp(count, [&] {
+        for (const auto& [name, info] : by_name) {
+            sum += info.restart_count;
+        }
+    }));
+    report("iterate slot map (per module)", nsPerOp(count, [&] {
+        for (const auto& info : slots) {
+            sum += info.restart_count;
+        }
+    }));
+    report("lookup unordered_map by name", nsPerOp(count, [&] {
+        for (size_t i : order) {
+            sum += by_name.find(names[i])->second.restart_count;
+        }
+    }));
+    report("lookup slot map by name (index)", nsPerOp(count, [&] {
+        for (size_t i : order) {
+            sum += slots.get(ids.find(names[i])->second)->restart_count;
+        }
+    }));
+    report("lookup slot map by id", nsPerOp(count, [&] {
+        for (size_t i : order) {
+            sum += slots.get(handles[i])->restart_count;
+        }
+    }));
+
+    // 通过ProcessManager的接口（包含加锁）
+    ProcessManager::SupervisorOptions options;
+    options.handle_signals = false;
+    ProcessManager::ProcessManager pm(options);
+    auto t0 = steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        pm.addModule(names[i], "/bin/true", false);
+    }
+    std::printf("%-40s %10.1f ms\n", "addModule x count",
+                duration<double, std::milli>(steady_clock::now() - t0).count());
+    for (size_t i = 0; i < count; ++i) {
+        handles[i] = pm.findModule(names[i]);
+    }
+    report("getModuleState(name)", nsPerOp(count, [&] {
+        for (size_t i : order) {
+            sum += static_cast<int>(pm.getModuleState(names[i]));
+        }
+    }));
+    report("getModuleState(id)", nsPerOp(count, [&] {
+        for (size_t i : order) {
+            sum += static_cast<int>(pm.getModuleState(handles[i]));
+        }
+    }));
+    report("getAllProcesses (per module)", nsPerOp(count, [&] {
+        sum += static_cast<long>(pm.getAllProcesses().size());
+    }));
+    pm.shutdown();
+
+    std::printf("(checksum %ld)\n", sum);
+    return 0;
+}
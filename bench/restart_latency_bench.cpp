@@ -0,0 +1,115 @@
+// 崩溃到重启的延迟对比：POLLING（1秒waitpid轮询）与 EVENT（pidfd + epoll）
+// 每次迭代用SIGKILL杀掉模块进程，测量到管理器拉起新PID所用的时间。
+// 第二部分同时杀掉一批模块，测量全部重启完成的时间（各模块的重启延迟并行计时）
+#include "process_manager/process_manager.h"
+#include <signal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+pid_t currentPid(const ProcessManager::ProcessManager& pm, ProcessManager::ModuleId id) {
+    const ProcessManager::ProcessInfo* info = pm.snapshot()->find(id);
+    return info ? info->pid : -1;
+}
+
+// 等待pid退出、模块重新进入RUNNING：由退出和启动的路径唤醒，不轮询
+void waitForRestart(ProcessManager::ProcessManager& pm, ProcessManager::ModuleId id, pid_t pid) {
+    auto deadline = steady_clock::now() + seconds(10);
+    pm.waitForExit(id, pid, deadline);
+    pm.waitForState(id, ProcessManager::ProcessState::RUNNING, deadline);
+}
+
+void run(ProcessManager::SupervisorMode mode, const char* label, int iterations) {
+    ProcessManager::SupervisorOptions options;
+    options.mode = mode;
+    options.restart_delay = milliseconds(0);  // 只测量退出检测本身的延迟
+    ProcessManager::ProcessManager pm(options);
+    pm.addModule("victim", "sleep 1000", true);
+    pm.startModule("victim");
+    ProcessManager::ModuleId victim = pm.findModule("victim");
+
+    std::atomic<bool> stop{false};
+    std::thread loop([&] {
+        while (!stop) {
+            pm.runOnce(1000);  // 与main.cpp中原有的1秒循环一致
+        }
+    });
+
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        pid_t old_pid = currentPid(pm, victim);
+        // 随机错开与轮询周期的相位
+        std::this_thread::sleep_for(milliseconds(37 * (i % 7)));
+        auto t0 = steady_clock::now();
+        kill(old_pid, SIGKILL);
+        waitForRestart(pm, victim, old_pid);
+        samples.push_back(duration<double, std::milli>(steady_clock::now() - t0).count());
+    }
+
+    stop = true;
+    loop.join();
+    pm.shutdown();
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) {
+        sum += s;
+    }
+    std::printf("%-8s n=%-3zu min=%9.3f ms  p50=%9.3f ms  avg=%9.3f ms  max=%9.3f ms\n", label,
+                samples.size(), samples.front(), samples[samples.size() / 2],
+                sum / samples.size(), samples.back());
+}
+
+void runBurst(int module_count, milliseconds restart_delay) {
+    ProcessManager::SupervisorOptions options;
+    options.mode = ProcessManager::SupervisorMode::EVENT;
+    options.restart_delay = restart_delay;
+    ProcessManager::ProcessManager pm(options);
+    for (int i = 0; i < module_count; ++i) {
+        std::string name = "m" + std::to_string(i);
+        pm.addModule(name, "sleep 1000", true);
+        pm.startModule(name);
+    }
+
+    std::atomic<bool> stop{false};
+    std::thread loop([&] {
+        while (!stop) {
+            pm.runOnce(1000);
+        }
+    });
+
+    auto processes = pm.getAllProcesses();
+    auto t0 = steady_clock::now();
+    for (const auto& info : processes) {
+        kill(info.pid, SIGKILL);
+    }
+    for (const auto& info : processes) {
+        waitForRestart(pm, info.id, info.pid);
+    }
+    double elapsed = duration<double, std::milli>(steady_clock::now() - t0).count();
+
+    stop = true;
+    loop.join();
+    pm.shutdown();
+    std::printf("BURST    %d simultaneous crashes, restart_delay=%lld ms: all restarted after %.1f ms "
+                "(serial restarts would take >= %lld ms)\n",
+                module_count, static_cast<long long>(restart_delay.count()), elapsed,
+                static_cast<long long>(restart_delay.count() * module_count));
+}
+
+} // namespace
+
+int main() {
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+    run(ProcessManager::SupervisorMode::POLLING, "POLLING", 10);
+    run(ProcessManager::SupervisorMode::EVENT, "EVENT", 50);
+    runBurst(100, milliseconds(500));
+    return 0;
+}
@@ -0,0 +1,58 @@
+// 分片监控器的启动吞吐：1、4、16个分片分别并行启动同样数量的模块，
+// 同时在另一个线程中持续查询模块状态，测量查询延迟（启动期间不受fork影响）
+#include "process_manager/sharded_process_manager.h"
+#include "process_manager/signal_handler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "ylt/easylog.hpp"
+
+using namespace std::chrono;
+
+static void runShards(size_t shard_count, int module_count) {
+    ProcessManager::SupervisorOptions options;
+    options.handle_signals = false;
+    ProcessManager::ShardedProcessManager pm(shard_count, options);
+    for (int i = 0; i < module_count; ++i) {
+        pm.addModule("m" + std::to_string(i), "sleep 1000", false);
+    }
+
+    std::atomic<bool> done{false};
+    std::vector<double> query_us;
+    std::thread querier([&] {
+        int i = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            auto q0 = steady_clock::now();
+            pm.getModuleState("m" + std::to_string(i++ % module_count));
+            query_us.push_back(duration<double, std::micro>(steady_clock::now() - q0).count());
+        }
+    });
+
+    auto t0 = steady_clock::now();
+    size_t started = pm.startAll();
+    double ms = duration<double, std::milli>(steady_clock::now() - t0).count();
+    done = true;
+    querier.join();
+
+    std::sort(query_us.begin(), query_us.end());
+    double p99 = query_us.empty() ? 0 : query_us[query_us.size() * 99 / 100];
+    std::printf("%2zu shards: %zu modules in %7.1f ms, %7.0f modules/sec, query p99 %.1f us\n",
+                shard_count, started, ms, started * 1000.0 / ms, p99);
+
+    pm.shutdown();
+}
+
+int main(int argc, char** argv) {
+    int module_count = argc > 1 ? std::atoi(argv[1]) : 1000;
+    ProcessManager::SignalHandler::blockSignals();
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+
+    for (size_t shards : {1, 4, 16}) {
+        runShards(shards, module_count);
+    }
+    return 0;
+}
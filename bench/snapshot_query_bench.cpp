@@ -0,0 +1,111 @@
+// 状态查询对重启延迟的影响：1000个运行中的模块，另一个线程以给定速率查询状态（模拟监控抓取），
+// 测量模块被SIGKILL后到新PID出现的延迟。查询读取已发布的快照，不获取管理器的锁，
+// 延迟应与无查询时一致。getAllProcesses会复制全部ProcessInfo，单核机器上复制本身占用CPU，单独列出
+#include "process_manager/process_manager.h"
+#include <signal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+// 等待模块进入RUNNING后读取PID（快照按句柄查找，不复制）
+pid_t runningPid(ProcessManager::ProcessManager& pm, ProcessManager::ModuleId id) {
+    pm.waitForState(id, ProcessManager::ProcessState::RUNNING, steady_clock::now() + seconds(10));
+    return pm.snapshot()->find(id)->pid;
+}
+
+void run(int modules, int queries_per_sec, bool copy, int iterations) {
+    ProcessManager::SupervisorOptions options;
+    options.mode = ProcessManager::SupervisorMode::EVENT;
+    options.handle_signals = false;
+    options.restart_delay = milliseconds(0);
+    options.launch_backend = ProcessManager::LaunchBackend::VFORK;
+    ProcessManager::ProcessManager pm(options);
+    for (int i = 0; i < modules; ++i) {
+        pm.addModule("m" + std::to_string(i), "sleep 1000", true);
+    }
+    pm.addModule("victim", "sleep 1000", true);
+    pm.startAll();
+    ProcessManager::ModuleId victim = pm.findModule("victim");
+
+    std::atomic<bool> stop{false};
+    std::thread loop([&] {
+        while (!stop) {
+            pm.runOnce(1000);
+        }
+    });
+
+    // 查询线程：每个周期读取全部模块（快照或getAllProcesses）并按名字查询一个模块，计为两次查询；
+    // 速率为0表示不查询
+    std::atomic<long> queries{0};
+    std::thread scraper([&] {
+        if (queries_per_sec <= 0) {
+            return;
+        }
+        auto interval = nanoseconds(2000000000L / queries_per_sec);
+        auto next = steady_clock::now();
+        size_t running = 0;
+        while (!stop) {
+            if (copy) {
+                running += pm.getAllProcesses().size();
+            } else {
+                for (const auto& info : pm.snapshot()->processes) {
+                    running += info.state == ProcessManager::ProcessState::RUNNING;
+                }
+            }
+            running += pm.getModuleState("m1") == ProcessManager::ProcessState::RUNNING;
+            queries.fetch_add(2, std::memory_order_relaxed);
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    std::vector<double> samples;
+    auto t_start = steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        pid_t old_pid = runningPid(pm, victim);
+        std::this_thread::sleep_for(milliseconds(1 + i % 5));
+        auto t0 = steady_clock::now();
+        kill(old_pid, SIGKILL);
+        pm.waitForExit(victim, old_pid, steady_clock::now() + seconds(10));
+        runningPid(pm, victim);
+        samples.push_back(duration<double, std::micro>(steady_clock::now() - t0).count());
+    }
+    double seconds = duration<double>(steady_clock::now() - t_start).count();
+
+    stop = true;
+    loop.join();
+    scraper.join();
+    pm.shutdown();
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) {
+        sum += s;
+    }
+    std::printf("%-16s %6d/s (measured %6.0f)  p50=%8.1f us  p99=%8.1f us  avg=%8.1f us  max=%8.1f us\n",
+                copy ? "getAllProcesses" : "snapshot", queries_per_sec, queries.load() / seconds,
+                samples[samples.size() / 2], samples[samples.size() * 99 / 100], sum / samples.size(), samples.back());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int modules = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+    std::printf("%d running modules, %d restarts per run\n", modules, iterations);
+    for (int rate : {0, 10000, 50000}) {
+        run(modules, rate, false, iterations);
+    }
+    run(modules, 10000, true, iterations);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// 冷缓存下的启动：每轮先用posix_fadvise(DONTNEED)把各模块的可执行文件和依赖库逐出页缓存，
+// 再批量启动（每个模块运行 <binary> --version 后退出），测量从startAll到全部模块退出的时间。
+// 对比不预热与warm_up（预读 + execveat）两种方式
+#include "process_manager/process_manager.h"
+#include "process_manager/binary_warmer.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "ylt/easylog.hpp"
+
+using namespace std::chrono;
+
+static const char* kBinaries[] = {
+    "/usr/bin/git", "/usr/bin/python3", "/usr/bin/perl", "/usr/bin/cmake", "/usr/bin/gcc", "/usr/bin/vim",
+    "/usr/bin/ssh", "/usr/bin/curl", "/usr/bin/openssl", "/usr/bin/tar", "/usr/bin/xz",
+};
+
+static std::vector<std::string> availableBinaries() {
+    std::vector<std::string> binaries;
+    for (const char* binary : kBinaries) {
+        if (access(binary, X_OK) == 0) {
+            binaries.push_back(binary);
+        }
+    }
+    return binaries;
+}
+
+// 逐出页缓存（只对干净页有效，不需要root）
+static void evict(const std::vector<std::string>& files) {
+    for (const auto& file : files) {
+        int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd != -1) {
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+}
+
+static double coldStart(const std::vector<std::string>& binaries, const std::vector<std::string>& files,
+                        int copies, bool warm_up) {
+    ProcessManager::SupervisorOptions options;
+    options.mode = ProcessManager::SupervisorMode::EVENT;
+    options.handle_signals = false;
+    options.launch_backend = ProcessManager::LaunchBackend::VFORK;
+    options.warm_up = warm_up;
+    ProcessManager::ProcessManager pm(options);
+    for (int c = 0; c < copies; ++c) {
+        for (const auto& binary : binaries) {
+            pm.addModule(binary + "#" + std::to_string(c), binary + " --version > /dev/null 2>&1", false);
+        }
+    }
+
+    evict(files);
+    auto t0 = steady_clock::now();
+    pm.startAll();
+    for (;;) {
+        bool running = false;
+        for (const auto& info : pm.getAllProcesses()) {
+            running |= info.state == ProcessManager::ProcessState::RUNNING;
+        }
+        if (!running) {
+            break;
+        }
+        pm.runOnce(10);
+    }
+    double ms = duration<double, std::milli>(steady_clock::now() - t0).count();
+    pm.shutdown();
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 5;
+    int copies = argc > 2 ? std::atoi(argv[2]) : 4;
+    easylog::init_log(easylog::Severity::WARN, "", false, false);
+
+    auto binaries = availableBinaries();
+    ProcessManager::BinaryWarmer warmer;
+    for (const auto& binary : binaries) {
+        int fd = warmer.warm(binary);
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+    std::printf("%zu binaries x %d copies, %zu files (%zu MB) evicted before each round\n", binaries.size(), copies,
+                warmer.files(), warmer.bytes() >> 20);
+
+    double cold = 0, warm = 0;
+    for (int round = 0; round < rounds; ++round) {
+        cold += coldStart(binaries, warmer.paths(), copies, false);
+        warm += coldStart(binaries, warmer.paths(), copies, true);
+    }
+    std::printf("%-24s %10.1f ms\n", "no warm-up", cold / rounds);
+    std::printf("%-24s %10.1f ms\n", "warm-up + execveat", warm / rounds);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "types.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <async_simple/coro/Lazy.h>
+#include "ylt/coro_io/io_context_pool.hpp"
+
+namespace coro_io {
+class period_timer;
+}
+
+namespace ProcessManager {
+
+// 协程版进程管理器：每个模块的生命周期（启动、等待退出、退避、重启）
+// 都是运行在同一个io_context上的协程，等待与退避均为异步定时器，
+// 不会阻塞线程，单线程即可监控大量模块。
+//
+// 可以传入宿主程序已有的asio executor嵌入使用。executor必须是单线程的
+// （io_context只由一个线程run），所有模块状态只在该线程上修改；
+// start/stop等协程完成后在该executor线程上恢复调用者。
+class AsyncProcessManager {
+public:
+    using executor_type = asio::io_context::executor_type;
+
+    explicit AsyncProcessManager(executor_type executor,
+                                 std::chrono::milliseconds restart_delay = std::chrono::milliseconds(500));
+    ~AsyncProcessManager();
+
+    AsyncProcessManager(const AsyncProcessManager&) = delete;
+    AsyncProcessManager& operator=(const AsyncProcessManager&) = delete;
+
+    // 配置管理（任意线程可调用）
+    bool addModule(const std::string& name, const std::string& command, bool auto_restart = true,
+                   const ModuleStdio& stdio = {});
+
+    // 进程控制
+    async_simple::coro::Lazy<bool> start(std::string name);
+    // 发送SIGTERM，timeout内未退出则SIGKILL；返回进程是否已退出
+    async_simple::coro::Lazy<bool> stop(std::string name,
+                                        std::chrono::milliseconds timeout = std::chrono::milliseconds(500));
+    // 停止所有模块，并等待所有监控协程（包括退避中的）结束；析构前必须等待其完成
+    async_simple::coro::Lazy<void> shutdown(std::chrono::milliseconds timeout = std::chrono::milliseconds(500));
+
+    // 状态查询（任意线程可调用）
+    ProcessState getModuleState(const std::string& name) const;
+    std::vector<ProcessInfo> getAllProcesses() const;
+    bool isRunning(const std::string& name) const;
+
+    coro_io::ExecutorWrapper<>* executor() { return &executor_; }
+
+private:
+    struct Module;
+
+    coro_io::ExecutorWrapper<> executor_;
+    std::chrono::milliseconds restart_delay_;
+    bool shutting_down_ = false;    // 只在executor线程访问
+    size_t supervisors_ = 0;        // 运行中的supervise协程数，只在executor线程访问
+    std::vector<coro_io::period_timer*> supervise_waiters_;    // shutdown等待supervisors_归零
+    mutable std::mutex mutex_;      // 保护modules_以及其中的ProcessInfo
+    std::unordered_map<std::string, std::shared_ptr<Module>> modules_;
+
+    std::shared_ptr<Module> findModule(const std::string& name) const;
+    bool launch(Module& module);
+    async_simple::coro::Lazy<void> supervise(std::shared_ptr<Module> module);
+    async_simple::coro::Lazy<int> waitForExit(Module& module);
+    async_simple::coro::Lazy<bool> waitExitFor(Module& module, std::chrono::milliseconds timeout);
+    void notifyExit(Module& module);
+    // 挂起直到waiters中的定时器被wake取消（都只在executor线程调用）
+    async_simple::coro::Lazy<void> waitWoken(std::vector<coro_io::period_timer*>& waiters);
+    static void wake(std::vector<coro_io::period_timer*>& waiters);
+};
+
+} // namespace ProcessManager
@@ -0,0 +1,40 @@
+#pragma once
+#include <sys/types.h>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ProcessManager {
+
+// 启动风暴之前的预热：对模块的可执行文件、ELF解释器（PT_INTERP）和DT_NEEDED依赖库
+// （递归，按RUNPATH/RPATH、LD_LIBRARY_PATH、ld.so.conf查找）以及脚本的#!解释器
+// 发起posix_fadvise(WILLNEED)，让内核并行地把它们读入页缓存，
+// 而不是每个模块exec时各自按需缺页读取。同一个预热器中每个文件只处理一次
+class BinaryWarmer {
+public:
+    // 预热path（相对路径按cwd解释）。可执行文件是ELF时返回它的O_PATH|O_CLOEXEC fd，
+    // 可交给启动计划用execveat启动；脚本或打开失败返回-1
+    int warm(const std::string& path, const std::string& cwd = {});
+
+    size_t files() const { return paths_.size(); }
+    size_t bytes() const { return bytes_; }
+    const std::vector<std::string>& paths() const { return paths_; }   // 已预热的文件
+
+private:
+    // 预热一个文件（已处理过的直接返回），返回它是否为ELF
+    bool prefetch(const std::string& path, int depth);
+    void prefetchNeeded(int fd, const std::string& path, int depth);
+    std::string findLibrary(const std::string& name, const std::vector<std::string>& search_dirs);
+    const std::vector<std::string>& systemLibraryDirs();
+
+    std::unordered_map<std::string, bool> seen_;     // 路径 -> 是否为ELF
+    std::set<std::pair<dev_t, ino_t>> seen_files_;   // 符号链接或不同路径指向的同一个文件
+    std::vector<std::string> paths_;
+    size_t bytes_ = 0;
+    std::vector<std::string> system_dirs_;
+    bool system_dirs_loaded_ = false;
+};
+
+} // namespace ProcessManager
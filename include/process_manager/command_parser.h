@@ -1,16 +1,48 @@
 #pragma once
 #include "types.h"
 #include <string>
+#include <vector>
 
 namespace ProcessManager {
 
+// 重定向：path非空时以open_flags打开该文件放到target；
+// 否则dup2(source, target)（source为子进程自己的fd），source为-1表示关闭target
+struct Redirect {
+    int target = -1;
+    int source = -1;
+    int open_flags = 0;
+    std::string path;
+};
+
+// 内置shell解释器的编译结果。cd、source/export、VAR=val、$VAR展开在编译时求值，
+// 重定向在子进程中exec之前执行，模块进程由execve直接启动，不经过bash
+struct ShellCommand {
+    CommandArgs args;
+    std::string cwd;                    // 为空表示继承管理器的工作目录
+    std::vector<std::string> env;       // 为空表示继承管理器的环境
+    std::vector<Redirect> redirects;
+    bool interpreted = true;            // false：语法超出支持范围，args为 /bin/bash -c <command>
+};
+
+// 命令行的单遍扫描结果
+struct CommandScan {
+    CommandArgs args;           // 不需要shell时的argv（已去除引号和转义）
+    bool needs_shell = false;   // 含有运算符、展开、通配符，或命令名是关键字、内置命令、赋值
+};
+
 class CommandParser {
 public:
     static CommandArgs parseCommand(const std::string& command_line);
-    static bool validateCommand(const CommandArgs& args);
-    
-private:
+    static CommandScan scan(const std::string& command_line);
+    // 与scan相同的判定，但不收集词，不分配内存
     static bool needsShell(const std::string& command);
+    // 编译命令行。支持的子集：以 && 或 ; 连接的 cd、export、unset、source/.、
+    // 变量赋值，最后是（可带exec和VAR=val前缀的）一条命令及其 < > >> N>&M &> 重定向；
+    // 词中的引号、转义、$VAR、${VAR}和参数开头的~、~/。管道、后台、子shell、命令替换、
+    // 通配符、花括号展开、~user、$'...'等其他语法退回 /bin/bash -c。mode为ALWAYS时直接使用
+    // /bin/bash -c，为NEVER时不退回bash，返回空的args。没有任何词的命令（空白、注释）返回空的args
+    static ShellCommand compile(const std::string& command_line, ShellMode mode = ShellMode::AUTO);
+    static bool validateCommand(const CommandArgs& args);
 };
 
 } // namespace ProcessManager
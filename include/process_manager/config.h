@@ -8,11 +8,20 @@ namespace ProcessManager {
 
 struct ModuleConfig {
     std::string command;
+    // 与command二选一：argv列表直接进入启动计划，不经过命令解析和shell
+    std::optional<std::vector<std::string>> argv;
+    // command的执行方式：true总是 /bin/bash -c，false从不使用bash，不设置则自动判断
+    std::optional<bool> shell;
     std::optional<std::vector<std::string>> depends_on;
     bool restart_on_failure;
     std::optional<std::map<std::string, std::string>> env;
+    // 标准输入输出重定向到的文件（例如/dev/null或日志文件，追加写入），不设置则继承
+    std::optional<std::string> stdin_path;
+    std::optional<std::string> stdout_path;
+    std::optional<std::string> stderr_path;
 };
-YLT_REFL(ModuleConfig, command, depends_on, restart_on_failure, env);
+YLT_REFL(ModuleConfig, command, argv, shell, depends_on, restart_on_failure, env, stdin_path, stdout_path,
+         stderr_path);
 
 struct ModulesConfig {
     std::map<std::string, ModuleConfig> modules;
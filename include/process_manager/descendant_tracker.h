@@ -0,0 +1,47 @@
+#pragma once
+#include <sys/types.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ProcessManager {
+
+// 模块后代进程索引：pid → 所属模块。
+// 以模块主进程为根，增量地从已跟踪进程的 /proc/<pid>/task/<tid>/children
+// 发现新的子孙进程，开销与被跟踪的进程树大小成正比，不扫描整个 /proc。
+class DescendantTracker {
+public:
+    void addRoot(pid_t root, const std::string& module);
+    void add(pid_t pid, const std::string& module);
+
+    // 从已跟踪进程出发发现新的后代，返回新增数量
+    size_t refresh();
+    // 主进程退出时它的子进程已过继给reaper，从已跟踪的进程出发找不到它们：
+    // reaper的直接子进程中未跟踪、进程组为group（主进程自成的进程组）的进程归入module。
+    // 进程组还有成员时其ID不会被复用。返回新增数量，它们的后代由refresh展开
+    size_t adoptOrphans(pid_t reaper, pid_t group, const std::string& module);
+
+    // 所属模块，未跟踪时返回nullptr
+    const std::string* moduleOf(pid_t pid) const;
+    // 移除一个已退出的进程，返回其所属模块
+    std::string remove(pid_t pid);
+    bool contains(pid_t pid) const { return owner_.count(pid) > 0; }
+    bool isRoot(pid_t pid) const { return roots_.count(pid) > 0; }
+
+    // 模块的后代进程（不含主进程）
+    std::vector<pid_t> descendantsOf(const std::string& module) const;
+    size_t count(const std::string& module) const;
+    std::vector<pid_t> all() const;
+    void clear();
+
+    // 读取进程所有线程的直接子进程
+    static std::vector<pid_t> readChildren(pid_t pid);
+
+private:
+    std::unordered_map<pid_t, std::string> owner_;
+    std::unordered_map<std::string, std::unordered_set<pid_t>> by_module_;
+    std::unordered_set<pid_t> roots_;
+};
+
+} // namespace ProcessManager
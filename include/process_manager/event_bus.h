@@ -0,0 +1,52 @@
+#pragma once
+#include "lifecycle_event.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ProcessManager {
+
+// 一个订阅者的有界环形缓冲区：单生产者（EventBus的分发方）、单消费者（订阅者）、无锁。
+// 缓冲区满时丢弃新事件并计数，不阻塞分发，也不影响其他订阅者。
+// 订阅者释放持有的shared_ptr即取消订阅
+class EventSubscription {
+public:
+    explicit EventSubscription(size_t capacity);
+    EventSubscription(const EventSubscription&) = delete;
+    EventSubscription& operator=(const EventSubscription&) = delete;
+
+    // 消费者侧：取出最早的事件，没有事件时返回false / 0
+    bool poll(LifecycleEvent& event);
+    size_t poll(LifecycleEvent* events, size_t max);
+    // 因缓冲区满而丢弃的事件数；事件的seq连续递增，也可据此发现缺口
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return mask_ + 1; }
+
+    // 生产者侧，由EventBus调用
+    bool push(const LifecycleEvent& event);
+
+private:
+    std::unique_ptr<LifecycleEvent[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<uint64_t> head_{0};     // 消费者写
+    alignas(64) std::atomic<uint64_t> tail_{0};     // 生产者写
+    std::atomic<uint64_t> dropped_{0};
+};
+
+// 生命周期事件的分发：每个订阅者一个EventSubscription，publish依次推入。
+// publish同一时刻只能有一个调用者（ProcessManager在drainEvents中调用）
+class EventBus {
+public:
+    // capacity向上取整为2的幂
+    std::shared_ptr<EventSubscription> subscribe(size_t capacity);
+    void publish(const LifecycleEvent* events, size_t count);
+
+private:
+    std::mutex mutex_;      // 只保护订阅者列表，不在管理器的锁内获取
+    std::vector<std::shared_ptr<EventSubscription>> subscriptions_;
+};
+
+} // namespace ProcessManager
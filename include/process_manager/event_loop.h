@@ -0,0 +1,47 @@
+#pragma once
+#include <sys/epoll.h>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace ProcessManager {
+
+// 基于epoll的事件循环，按fd注册回调
+class EventLoop {
+public:
+    using Callback = std::function<void(uint32_t events)>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool isValid() const { return epoll_fd_ != -1; }
+
+    bool add(int fd, Callback callback, uint32_t events = EPOLLIN);
+    bool remove(int fd);
+
+    // 等待事件并分发回调，返回处理的事件数，出错返回-1
+    // timeout_ms < 0 表示无限等待
+    int runOnce(int timeout_ms);
+
+    // 从其他线程唤醒阻塞中的runOnce（例如新增了更早到期的定时器）
+    void wakeup();
+
+private:
+    struct Watch {
+        int fd;
+        Callback callback;
+    };
+
+    int epoll_fd_ = -1;
+    int wakeup_fd_ = -1;
+    uint64_t next_token_ = 1;
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, Watch> watches_;
+    std::unordered_map<int, uint64_t> fd_to_token_;
+};
+
+} // namespace ProcessManager
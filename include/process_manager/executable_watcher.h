@@ -0,0 +1,69 @@
+#pragma once
+#include <sys/types.h>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ProcessManager {
+
+class LaunchPlan;
+
+// 通过inotify监视模块可执行文件所在的目录，以及PATH中排在它之前的目录。
+// 可执行文件被替换、修改、删除，或PATH中更靠前的目录出现同名文件时，
+// 通知管理器重新解析路径并重建启动计划。监视目录而不是文件本身，
+// 部署时常见的"写临时文件再rename"也能被发现。非线程安全，由调用方加锁
+class ExecutableWatcher {
+public:
+    using Callback = std::function<void(const std::string& module)>;
+
+    ExecutableWatcher() = default;
+    ~ExecutableWatcher();
+
+    ExecutableWatcher(const ExecutableWatcher&) = delete;
+    ExecutableWatcher& operator=(const ExecutableWatcher&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return fd_ != -1; }
+    int fd() const { return fd_; }
+
+    // 开始（或重新）监视模块的可执行文件。返回可执行文件是否与上次监视时不同
+    // （被替换、修改或解析到了另一个文件），首次监视返回false
+    bool watch(const std::string& module, const LaunchPlan& plan);
+    void unwatch(const std::string& module);
+    void clear();
+
+    // 读取所有待处理事件（非阻塞），每个受影响的模块回调一次。
+    // 事件队列溢出时所有模块都视为受影响
+    void readEvents(const Callback& callback);
+
+private:
+    struct FileId {
+        dev_t dev = 0;
+        ino_t ino = 0;
+        off_t size = 0;
+        timespec mtime{};
+    };
+
+    struct Module {
+        std::string path;
+        FileId id;
+        std::vector<std::pair<int, std::string>> files;    // (wd, 文件名)
+    };
+
+    static FileId identify(const std::string& path);
+    static bool sameFile(const FileId& a, const FileId& b);
+    void removeWatch(int wd);
+
+    int fd_ = -1;
+    std::unordered_map<std::string, int> dir_wd_;      // 目录 -> wd（符号链接目录可能共用一个wd）
+    // wd -> 文件名 -> 关心该文件的模块
+    std::unordered_map<int, std::unordered_map<std::string, std::unordered_set<std::string>>> dirs_;
+    std::unordered_map<std::string, Module> modules_;
+};
+
+} // namespace ProcessManager
@@ -0,0 +1,80 @@
+#pragma once
+#include "types.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ProcessManager {
+
+// 子进程chdir之后、exec之前按顺序执行的fd操作。之后除0/1/2和各操作的target之外，
+// 其他fd都在exec时关闭
+struct FdAction {
+    enum Type : uint32_t {
+        DUP2,   // dup2(source, target)，source是管理器中的fd（经zygote启动时随SCM_RIGHTS传递）；
+                // source == target表示原样继承该fd
+        CLOSE,  // close(target)
+        OPEN,   // open(path, open_flags, 0666)并放到target（shell重定向 > >> <）
+        COPY,   // dup2(source, target)，source是子进程自己的fd（shell重定向 2>&1）
+    };
+    Type type = DUP2;
+    int source = -1;
+    int target = -1;
+    int open_flags = 0;
+    const char* path = nullptr;     // OPEN：构建计划时复制到arena中
+};
+
+struct ShellCommand;
+
+// 预编译的启动计划：在addModule时构建一次，之后不可变。
+// argv、envp、解析后的可执行文件路径、工作目录都存放在同一块内存中，
+// 启动（包括每次重启）只需clone + exec，不再解析命令、不分配内存。
+class LaunchPlan {
+public:
+    // envp为空时使用构建时的environ快照
+    static std::shared_ptr<const LaunchPlan> build(const CommandArgs& args, const std::string& cwd = {},
+                                                   std::vector<FdAction> fd_actions = {},
+                                                   const std::vector<std::string>* envp = nullptr);
+    // 由内置shell解释器的编译结果构建：工作目录、环境和重定向都进入计划，
+    // stdio的fd操作排在命令自身的重定向之前
+    static std::shared_ptr<const LaunchPlan> build(const ShellCommand& command, const ModuleStdio& stdio = {});
+
+    const char* path() const { return path_; }
+    char* const* argv() const { return argv_; }
+    char* const* envp() const { return envp_; }
+    const char* cwd() const { return cwd_; }     // 为nullptr表示继承管理器的工作目录
+    const std::vector<FdAction>& fdActions() const { return fd_actions_; }
+    size_t arenaSize() const { return arena_size_; }
+    // 预热时打开的可执行文件O_PATH fd，启动时用execveat代替按路径查找；-1表示没有。
+    // 子进程在execveat之前确认路径仍指向同一inode，否则按路径启动
+    int execFd() const { return exec_fd_; }
+
+    // 复制出一个持有exec_fd的计划（接管fd的所有权）。可执行文件变化时重建的计划不带fd，
+    // 旧的fd随旧计划一起关闭
+    std::shared_ptr<const LaunchPlan> withExecFd(int exec_fd) const;
+
+    ~LaunchPlan();
+
+    // 预先序列化的形式，用于发送给zygote；fd操作的源fd需另外通过SCM_RIGHTS按顺序传递
+    const std::string& wire() const { return wire_; }
+    static std::shared_ptr<const LaunchPlan> fromWire(const char* data, size_t size, const int* fds, size_t fd_count);
+
+private:
+    LaunchPlan() = default;
+
+    static std::shared_ptr<LaunchPlan> make(const char* path, const std::vector<const char*>& args,
+                                            const std::vector<const char*>& env, const char* cwd,
+                                            std::vector<FdAction> fd_actions);
+
+    std::unique_ptr<char[]> arena_;
+    size_t arena_size_ = 0;
+    const char* path_ = nullptr;
+    char* const* argv_ = nullptr;
+    char* const* envp_ = nullptr;
+    const char* cwd_ = nullptr;
+    std::vector<FdAction> fd_actions_;
+    int exec_fd_ = -1;
+    std::string wire_;
+};
+
+} // namespace ProcessManager
@@ -0,0 +1,56 @@
+#pragma once
+#include "types.h"
+#include <sys/resource.h>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace ProcessManager {
+
+// 模块生命周期事件：定长、可平凡复制。在管理器的锁内只填写这样一条记录并推入无锁队列，
+// 格式化、日志和分发给订阅者（EventBus）都在锁外进行
+struct LifecycleEvent {
+    enum class Type : uint8_t {
+        STARTED,            // pid
+        START_FAILED,       // error；state为之后的状态（FAILED / CRASHED等待重试 / STOPPED）
+        EXITED,             // pid、status（waitpid状态）、usage；state为退出时的状态（RUNNING / STOPPING）
+        RESTART_SCHEDULED,  // delay_ms、restart_count、reason（CRASHED或REQUESTED）
+        STOPPING,           // pid，已发送SIGTERM
+        KILLED,             // pid，停止超时后发送SIGKILL
+        STOPPED,            // 不会再重启，reason说明原因
+        HEALTH_CHANGED,     // health为新的健康状态
+        CONFIG_RELOADED,    // 不属于某个模块（id无效、name为空）；error非0表示加载失败，保持原配置
+    };
+    enum class Reason : uint8_t {
+        NONE,
+        CRASHED,            // 异常退出或启动失败后自动重启
+        REQUESTED,          // restartModule
+        SHUTTING_DOWN,
+        AUTO_RESTART_DISABLED,
+        STOP_REQUESTED,     // stopModule或移除模块
+    };
+
+    static constexpr size_t kMaxName = 63;
+
+    Type type = Type::STARTED;
+    Reason reason = Reason::NONE;
+    ProcessState state = ProcessState::STOPPED;  // 事件之后模块的状态（EXITED除外）
+    ModuleId id;
+    uint64_t seq = 0;           // 管理器内的递增序号（在锁内分配）
+    pid_t pid = -1;
+    int status = 0;
+    int error = 0;
+    int restart_count = 0;
+    int64_t delay_ms = 0;
+    ModuleHealth health = ModuleHealth::UNKNOWN;
+    struct rusage usage {};
+    char name[kMaxName + 1] = {};   // 模块名，超长时截断
+
+    void setName(std::string_view module) {
+        size_t size = module.size() < kMaxName ? module.size() : kMaxName;
+        std::memcpy(name, module.data(), size);
+        name[size] = '\0';
+    }
+};
+
+} // namespace ProcessManager
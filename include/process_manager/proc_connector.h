@@ -0,0 +1,44 @@
+#pragma once
+#include <sys/types.h>
+#include <functional>
+
+namespace ProcessManager {
+
+// 内核进程事件（netlink proc connector, cn_proc）
+struct ProcEvent {
+    enum class Type { FORK, EXEC, EXIT };
+
+    Type type;
+    pid_t pid;           // 事件进程（线程组ID）
+    pid_t parent;        // FORK: 父进程；EXIT: 退出时的父进程（旧内核为0）
+    int exit_code = 0;   // EXIT: wait状态
+};
+
+// 订阅 NETLINK_CONNECTOR 的 CN_IDX_PROC 组，接收全系统的fork/exec/exit事件。
+// 需要 CAP_NET_ADMIN；open() 失败时调用方应退化为仅依赖pidfd。
+class ProcConnector {
+public:
+    using Callback = std::function<void(const ProcEvent&)>;
+
+    ProcConnector() = default;
+    ~ProcConnector();
+
+    ProcConnector(const ProcConnector&) = delete;
+    ProcConnector& operator=(const ProcConnector&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return fd_ != -1; }
+    int fd() const { return fd_; }
+
+    // 读取所有待处理事件（非阻塞）。线程级fork/exit被过滤掉。
+    // 内核缓冲区溢出丢失事件时返回false，调用方需要重新同步进程树。
+    bool readEvents(const Callback& callback);
+
+private:
+    bool sendControl(bool listen);
+
+    int fd_ = -1;
+};
+
+} // namespace ProcessManager
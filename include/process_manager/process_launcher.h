@@ -2,14 +2,50 @@
 #include "types.h"
 #include <optional>
 #include <signal.h>
+#include <sys/resource.h>
 
 namespace ProcessManager {
 
+struct LaunchOptions {
+    LaunchBackend backend = LaunchBackend::FORK;
+    int cgroup_fd = -1;     // CLONE3：通过CLONE_INTO_CGROUP直接在该cgroup中创建子进程
+    // CLONE3/VFORK：以CLONE_PARENT创建，子进程的父进程是调用者的父进程（zygote使用）。
+    // 此时exec失败的子进程由真正的父进程回收，pidfd仍会写入供其回收
+    bool clone_parent = false;
+    // 子进程自成一个进程组（pgid = pid），它的后代默认留在组内。收割者模式据此认领过继的孤儿
+    bool new_process_group = false;
+};
+
+class LaunchPlan;
+
 class ProcessLauncher {
 public:
-    static std::optional<pid_t> launch(const CommandArgs& args);
+    // 按启动计划启动进程。argv/envp和可执行文件路径都在计划中准备好，
+    // 子进程中只执行fd操作、chdir、sigprocmask、execve和_exit，不分配内存。
+    // pidfd非空且后端能原子地返回pidfd（CLONE3、VFORK）时写入，否则写入-1。
+    // exec失败（包括fd操作、chdir失败）会同步报告：返回nullopt，errno为失败原因，
+    // 子进程已被回收，调用者不会再收到它的退出事件。启动器本身不记录日志，
+    // 可以在fork出的单线程进程（zygote）中安全使用
+    static std::optional<pid_t> launch(const LaunchPlan& plan, const LaunchOptions& options = {},
+                                       int* pidfd = nullptr);
+    // 临时构建启动计划后启动
+    static std::optional<pid_t> launch(const CommandArgs& args, const LaunchOptions& options = {},
+                                       int* pidfd = nullptr);
     static bool terminate(pid_t pid, int signal = SIGTERM);
     static bool isProcessAlive(pid_t pid);
+    // 为子进程打开pidfd，内核不支持时返回-1
+    static int openPidfd(pid_t pid);
+    // 非阻塞地回收指定子进程并取得rusage。有pidfd时使用waitid(P_PIDFD)，
+    // 不受PID复用影响；否则使用wait4。status为waitpid格式。
+    // 返回pid表示已回收，0表示仍在运行，-1表示出错（例如已被其他代码回收）
+    static pid_t reap(pid_t pid, int pidfd, int* status, struct rusage* usage);
+    // 重试也不会成功的启动错误（可执行文件不存在、无权限、格式错误等）。
+    // ETXTBSY不在其中：可执行文件正被部署写入，稍后重试即可
+    static bool isPermanentError(int err);
+    // 按PATH查找可执行文件（与execvp相同的规则，只接受可执行的普通文件）。
+    // 含'/'的路径原样返回；找不到时返回空字符串，启动时以ENOENT失败。
+    // search_path为空指针时使用管理器的PATH
+    static std::string resolveExecutable(const std::string& file, const char* search_path = nullptr);
 };
 
 } // namespace ProcessManager
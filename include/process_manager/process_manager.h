@@ -1,47 +1,271 @@
 #pragma once
 #include "types.h"
+#include "event_loop.h"
+#include "timer_wheel.h"
+#include "descendant_tracker.h"
+#include "proc_connector.h"
+#include "executable_watcher.h"
+#include "binary_warmer.h"
+#include "process_launcher.h"
+#include "launch_plan.h"
+#include "slot_map.h"
+#include "timed_mutex.h"
+#include "lifecycle_event.h"
+#include "event_bus.h"
+#include "zygote.h"
 #include <unordered_map>
 #include <memory>
+#include <optional>
+#include <span>
+#include <functional>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string_view>
 #include "ylt/easylog.hpp"
+#include "ylt/util/atomic_shared_ptr.hpp"
+#include "ylt/util/concurrentqueue.h"
 
 namespace ProcessManager {
 
+// 某一时刻所有模块信息的只读快照，发布后不再修改，可在任意线程中不加锁地读取
+struct ProcessSnapshot {
+    uint64_t version = 0;
+    std::vector<ProcessInfo> processes;
+
+    // 不存在时返回nullptr
+    const ProcessInfo* find(ModuleId id) const;
+    const ProcessInfo* find(std::string_view name) const;
+
+    std::vector<uint32_t> by_slot;  // ModuleId::index -> processes中的下标
+    std::vector<uint32_t> by_name;  // 按名字排序的processes下标
+};
+
 class ProcessManager {
 public:
-    ProcessManager();
+    explicit ProcessManager(SupervisorOptions options = {});
     ~ProcessManager();
 
     // 配置管理
-    bool addModule(const std::string& name, const std::string& command, bool auto_restart = true);
+    bool addModule(const std::string& name, const std::string& command, bool auto_restart = true,
+                   const ModuleStdio& stdio = {}, ShellMode shell = ShellMode::AUTO);
+    // argv形式：不经过命令解析和shell，argv[0]按PATH查找后直接exec
+    bool addModuleArgv(const std::string& name, const CommandArgs& argv, bool auto_restart = true,
+                       const ModuleStdio& stdio = {});
     bool removeModule(const std::string& name);
+    // 名字对应的模块句柄，不存在时返回无效句柄。按句柄的接口不做名字查找，
+    // 频繁操作同一模块的调用者可以只查找一次
+    ModuleId findModule(const std::string& name) const;
     
     // 进程控制
     bool startModule(const std::string& name);
+    bool startModule(ModuleId id);
+    // 批量启动：加锁一次准备全部启动计划，锁外用launch_threads个线程（或zygote）
+    // 并行创建子进程，再加锁一次登记结果。返回结果与names一一对应
+    std::vector<StartResult> startModules(std::span<const std::string> names);
+    std::vector<StartResult> startAll();    // 启动所有STOPPED/FAILED状态的模块
+    // 预热：对模块的可执行文件、ELF解释器和DT_NEEDED依赖库发起预读，
+    // ELF可执行文件的O_PATH fd保存在启动计划中，之后的启动使用execveat。返回预热的文件数
+    size_t warmUp(std::span<const std::string> names);
     bool stopModule(const std::string& name);
+    bool stopModule(ModuleId id);
+    // 运行中的模块先停止，退出后立即重新启动（不阻塞调用者）
     bool restartModule(const std::string& name);
+    bool restartModule(ModuleId id);
     
-    // 状态查询
+    // 状态查询：都读取已发布的快照，不获取管理器的锁，不会推迟退出处理和启动
     ProcessState getModuleState(const std::string& name) const;
+    ProcessState getModuleState(ModuleId id) const;
     std::vector<ProcessInfo> getAllProcesses() const;
+    // 当前快照（不复制ProcessInfo）。状态变化后第一次读取时在锁内重建一次，
+    // 事件循环处理完事件后也会及时发布，之后直到下一次变化的读取都不加锁
+    std::shared_ptr<const ProcessSnapshot> snapshot() const;
     bool isRunning(const std::string& name) const;
     bool shouldExit() const;
-    void processRestartQueue();
+    // 阻塞等待模块进入state，或当前进程（waitForExit(id, pid, ...)为指定的进程）退出。
+    // 由退出和状态变化的路径唤醒，转换发生后立即返回；短暂经过的状态也算到达。
+    // 超时或模块不存在、被移除时返回false。不能在runOnce所在线程（定时器、信号回调）中调用
+    bool waitForState(const std::string& name, ProcessState state, std::chrono::steady_clock::time_point deadline);
+    bool waitForState(ModuleId id, ProcessState state, std::chrono::steady_clock::time_point deadline);
+    bool waitForExit(const std::string& name, std::chrono::steady_clock::time_point deadline);
+    bool waitForExit(ModuleId id, std::chrono::steady_clock::time_point deadline);
+    bool waitForExit(ModuleId id, pid_t pid, std::chrono::steady_clock::time_point deadline);
+    
+    // 订阅生命周期事件（启动、退出、计划重启、停止、健康状态变化、配置重新加载等）：
+    // 每个订阅者有自己容量为capacity的缓冲区，在任意一个线程中poll，不获取管理器的锁；
+    // 消费跟不上时新事件被丢弃并计入dropped()。释放返回的指针即取消订阅
+    std::shared_ptr<EventSubscription> subscribe(size_t capacity = kEventQueueCapacity);
+    // 外部健康检查上报模块的健康状态，变化时发布HEALTH_CHANGED事件。模块不存在时返回false
+    bool reportHealth(const std::string& name, ModuleHealth health);
+    bool reportHealth(ModuleId id, ModuleHealth health);
+    // 配置重新加载完成后由调用者通知，发布CONFIG_RELOADED事件；error非0表示加载失败
+    void notifyConfigReloaded(int error = 0);
+    // 管理器锁的持有时间统计（需开启SupervisorOptions::lock_stats）
+    LockStats lockStats() const { return mutex_.stats(); }
+    void resetLockStats() { mutex_.resetStats(); }
+    void processRestartQueue();     // 兼容旧接口，等同于processTimers()
     void checkChildProcesses();
+
+    // 主循环单步：等待子进程事件（最多timeout_ms毫秒，且不晚于最近的定时器）
+    // 并执行到期的定时器。EVENT模式下无事件时不占用CPU；
+    // POLLING模式下等同于一次轮询加休眠
+    void runOnce(int timeout_ms);
+
+    // 定时器：重启延迟、SIGKILL升级以及周期任务（状态报告、健康检查等）
+    // 都是时间轮中的O(1)条目，回调在runOnce所在线程中、锁外执行
+    void processTimers();
+    TimerWheel::TimerId schedulePeriodic(std::chrono::milliseconds interval, std::function<void()> task);
+    bool cancelTimer(TimerWheel::TimerId id);
+    // 在runOnce所在线程中尽快执行task（可从任意线程调用）
+    void post(std::function<void()> task);
+
+    // 注册信号回调（SIGHUP、SIGUSR1等），在事件循环线程中同步调用
+    // SIGINT/SIGTERM/SIGCHLD 的内置处理之后也会调用已注册的回调
+    void setSignalCallback(int signo, std::function<void()> callback);
     
     // 事件处理
-    void onChildExit(pid_t pid, int status);
+    void onChildExit(pid_t pid, int status, const struct rusage* usage = nullptr);
     void shutdown();
 
 private:
-    mutable std::mutex mutex_;
-    std::unordered_map<std::string, ProcessInfo> processes_;
-    std::unordered_map<pid_t, std::string> pid_to_name_;
-    std::vector<std::string> restart_queue_;
+    using PidMap = std::unordered_map<pid_t, ModuleId>;
+    
+    // 在锁内从模块上摘下、析构时（锁外）才释放的资源：
+    // 退出处理的临界区内不调用epoll_ctl/close，也不释放内存
+    struct Retired {
+        EventLoop* loop = nullptr;
+        int pidfd = -1;
+        PidMap::node_type pid_node;
+        
+        Retired() = default;
+        explicit Retired(EventLoop* event_loop) : loop(event_loop) {}
+        Retired(const Retired&) = delete;
+        Retired& operator=(const Retired&) = delete;
+        ~Retired();
+    };
+    
+    // 正在启动（锁外创建进程）的模块
+    struct PendingStart {
+        ModuleId id;
+        std::shared_ptr<const LaunchPlan> plan;
+        std::optional<pid_t> pid;
+        int pidfd = -1;
+        int error = 0;
+        PidMap::node_type pid_node;     // 锁外分配好的pid索引节点
+        Retired retired;                // 登记前已退出时摘下的资源
+    };
+
+    SupervisorOptions options_;
+    LaunchOptions launch_options_;
+    Zygote zygote_;
+    EventLoop loop_;
+    std::atomic<bool> pidfd_supported_{true};   // pidfd不可用时EVENT模式退化为轮询
+    int signal_fd_ = -1;
+    std::unordered_map<int, std::function<void()>> signal_callbacks_;
+    mutable TimedMutex mutex_;
+    // 模块连续存放在slot map中，内部（退出处理、定时器、重启）都按句柄访问；
+    // 名字只在接口边界通过ids_转换为句柄
+    struct Module {
+        ProcessInfo info;
+        std::shared_ptr<const LaunchPlan> plan;     // addModule时构建
+        TimerWheel::TimerId restart_timer = TimerWheel::kInvalidTimer;  // 等待中的重启
+        TimerWheel::TimerId kill_timer = TimerWheel::kInvalidTimer;     // 等待中的SIGKILL升级
+        bool restart_after_stop = false;            // restartModule发起的停止
+    };
+    SlotMap<Module> modules_;
+    std::unordered_map<std::string, ModuleId> ids_;
+    PidMap pid_to_id_;
+    TimerWheel timers_;
+    // 生命周期事件：锁内只推入定长记录（所有生产者都持有mutex_，共用一个显式生产者，保持顺序），
+    // drainEvents在锁外格式化并写日志
+    static constexpr size_t kEventQueueCapacity = 1024;
+    ylt::detail::moodycamel::ConcurrentQueue<LifecycleEvent> events_{kEventQueueCapacity};
+    ylt::detail::moodycamel::ProducerToken event_producer_{events_};
+    uint64_t event_seq_ = 0;
+    std::mutex drain_mutex_;
+    std::atomic<bool> drain_pending_{false};
+    EventBus bus_;      // 由drainEvents在锁外分发给订阅者
+    // waitForState / waitForExit的等待者，由emitLocked按事件标记完成，只在有等待者时通知
+    struct StateWaiter {
+        ModuleId id;
+        ProcessState state = ProcessState::STOPPED;
+        pid_t pid = -1;         // 大于0时等待该进程退出
+        bool done = false;
+    };
+    std::vector<StateWaiter*> waiters_;
+    std::condition_variable_any state_changed_;
+    // 模块信息每次变化（在锁内）版本加一；快照的版本落后时重新发布。只有个别模块变化时，
+    // 锁内只复制dirty_中的模块，其余部分在锁外从上一个快照复制；增删模块时完整重建
+    std::atomic<uint64_t> version_{1};
+    mutable std::vector<ModuleId> dirty_;
+    mutable bool rebuild_ = true;
+    mutable std::mutex publish_mutex_;      // 串行化发布者，不阻塞管理器的锁
+    mutable ylt::util::atomic_shared_ptr<const ProcessSnapshot> snapshot_;
+    mutable std::atomic<bool> snapshot_read_{false};   // 有读取者时事件循环才主动发布
     bool shutting_down_ = false;
+    size_t starting_count_ = 0;
+    // 模块被移除时尚未退出的进程：继续监视和回收，停止超时后升级为SIGKILL
+    struct RemovedProcess {
+        std::string name;
+        int pidfd = -1;
+        TimerWheel::TimerId kill_timer = TimerWheel::kInvalidTimer;
+    };
+    std::unordered_map<pid_t, RemovedProcess> removed_;
+    // 登记之前就被waitpid(-1)回收的子进程：pid -> (status, rusage)
+    std::unordered_map<pid_t, std::pair<int, struct rusage>> early_exits_;
+    bool subreaper_ = false;
+    DescendantTracker descendants_;
+    ProcConnector proc_events_;
+    std::mutex proc_events_mutex_;              // 串行化cn_proc的读取与应用，先于mutex_获取
+    std::vector<ProcEvent> proc_event_buffer_;  // 由proc_events_mutex_保护，复用以免每次分配
+    ExecutableWatcher executables_;
     
-    void updateProcessState(const std::string& name, ProcessState state);
-    void cleanupProcess(const std::string& name);
+    bool addModule(ProcessInfo info);
+    static ShellCommand compileModule(const ProcessInfo& info);
+    ModuleId findLocked(const std::string& name) const;
+    // 增删模块或无法确定变化的模块时，下次发布完整重建
+    void changedLocked() {
+        rebuild_ = true;
+        version_.fetch_add(1, std::memory_order_release);
+        if (!waiters_.empty()) {
+            state_changed_.notify_all();    // 模块可能已被移除
+        }
+    }
+    void changedLocked(ModuleId id);
+    LifecycleEvent eventLocked(LifecycleEvent::Type type, const ProcessInfo& info);
+    void emitLocked(const LifecycleEvent& event);
+    void drainEvents();
+    bool waitLocked(std::unique_lock<TimedMutex>& lock, StateWaiter& waiter,
+                    std::chrono::steady_clock::time_point deadline);
+    void logEvent(const LifecycleEvent& event) const;
+    std::shared_ptr<const ProcessSnapshot> publish() const;
+    bool prepareStartLocked(ModuleId id, PendingStart& start);
+    void spawn(PendingStart& start);
+    bool finishStartLocked(PendingStart& start);
+    void handleChildExitLocked(pid_t pid, int status, const struct rusage* usage, Retired& retired);
+    void cleanupProcess(Module& module, Retired* retired = nullptr);
+    void watchChild(ProcessInfo& info, int pidfd = -1);
+    void onPidfdReadable(pid_t pid, int pidfd);
+    bool ownsPidfdLocked(pid_t pid, int pidfd) const;
+    void onRemovedStopTimeout(pid_t pid);
+    void onSignalReadable();
+    pid_t stopLocked(Module& module);
+    void scheduleRestart(Module& module, std::chrono::milliseconds delay, LifecycleEvent::Reason reason);
+    bool cancelRestart(Module& module);
+    void onRestartTimer(ModuleId id);
+    void onStopTimeout(ModuleId id, pid_t pid);
+    void reapOwned(std::vector<pid_t>& pids);
+    pid_t reapChild(pid_t pid);
+    void refreshDescendants();
+    void pruneDescendants();
+    void onDescendantExit(pid_t pid, int status);
+    // 主进程退出后，把过继给管理器、仍在其进程组中的孤儿归入模块
+    void adoptOrphansLocked(pid_t root, const std::string& name);
+    void terminateDescendants(const std::string& name);
+    void onProcEventsReadable();
+    void onProcEvent(const ProcEvent& event);
+    void onExecutablesReadable();
+    bool trackingDescendants() const { return subreaper_ || proc_events_.isOpen(); }
 };
 
 } // namespace ProcessManager
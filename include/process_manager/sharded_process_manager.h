@@ -0,0 +1,65 @@
+#pragma once
+#include "process_manager.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ProcessManager {
+
+// 分片的多线程进程管理器：模块按名称哈希分配到N个分片，
+// 每个分片是一个独立的ProcessManager（自己的锁、事件循环、定时器和回收），
+// 由一个专属线程驱动。启动某个模块只锁住它所在的分片；
+// 状态查询直接读取各分片的快照（ProcessManager::snapshot），不获取任何分片锁。
+//
+// 各分片只回收自己的进程（reap_owned_only），并强制使用EVENT模式；
+// 只有分片0接管信号，调用者需在创建任何线程之前调用SignalHandler::blockSignals()。
+class ShardedProcessManager {
+public:
+    explicit ShardedProcessManager(size_t shard_count, SupervisorOptions options = {});
+    ~ShardedProcessManager();
+
+    ShardedProcessManager(const ShardedProcessManager&) = delete;
+    ShardedProcessManager& operator=(const ShardedProcessManager&) = delete;
+
+    // 配置管理与进程控制：直接转发到所属分片，只锁该分片
+    bool addModule(const std::string& name, const std::string& command, bool auto_restart = true,
+                   const ModuleStdio& stdio = {}, ShellMode shell = ShellMode::AUTO);
+    bool addModuleArgv(const std::string& name, const CommandArgs& argv, bool auto_restart = true,
+                       const ModuleStdio& stdio = {});
+    bool removeModule(const std::string& name);
+    bool startModule(const std::string& name);
+    bool stopModule(const std::string& name);
+    bool restartModule(const std::string& name);
+
+    // 每个分片在自己的线程中批量启动其全部STOPPED/FAILED模块，返回启动成功的数量
+    size_t startAll();
+
+    // 状态查询：读取所属分片（getAllProcesses为各分片）的快照
+    ProcessState getModuleState(const std::string& name) const;
+    std::vector<ProcessInfo> getAllProcesses() const;
+    bool isRunning(const std::string& name) const;
+    bool shouldExit() const;
+
+    size_t shardCount() const { return shards_.size(); }
+    size_t shardOf(const std::string& name) const;
+    ProcessManager& shard(size_t index) { return *shards_[index]->manager; }
+
+    // 停止所有分片线程，并行关闭各分片
+    void shutdown();
+
+private:
+    struct Shard {
+        std::unique_ptr<ProcessManager> manager;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> stopping_{false};
+    bool shut_down_ = false;
+
+    void run(Shard& shard);
+};
+
+} // namespace ProcessManager
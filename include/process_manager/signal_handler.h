@@ -2,14 +2,27 @@
 #include <functional>
 #include <unistd.h>
 #include <atomic>
+#include <signal.h>
 
 namespace ProcessManager {
 
 class SignalHandler {
 public:
+    // sigaction方式：处理器只设置原子标志（POLLING模式或signalfd不可用时使用）。
+    // 在调用线程中解除SIGINT/SIGTERM的阻塞，使信号由该线程的处理器接收
     static void setupShutdownHandler();
     static bool shouldShutdown();
+    static void requestShutdown();
     static void resetShutdownFlag();
+
+    // signalfd方式：SIGCHLD/SIGTERM/SIGINT/SIGHUP/SIGUSR1/SIGUSR2被阻塞，
+    // 通过fd同步读取并与其他I/O一起多路复用，不存在异步信号安全问题。
+    // blockSignals()应在创建任何线程之前调用，新线程会继承信号掩码。
+    static bool blockSignals();
+    static int createSignalFd();
+    // 从非阻塞signalfd读取一个信号，没有待处理信号时返回0
+    static int readSignal(int fd);
+    static void managedSignals(sigset_t* set);
     
 private:
     static std::atomic<bool> shutdown_requested_;
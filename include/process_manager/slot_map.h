@@ -0,0 +1,106 @@
+#pragma once
+#include "types.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ProcessManager {
+
+// 分代slot map：值连续存放（删除时用末尾元素填补空位），句柄为slot下标 + 代数。
+// slot的代数在分配和释放时各加一，占用中的slot代数为奇数，已释放元素的旧句柄
+// 不会指向复用该slot的新元素。按句柄查找、插入、删除都是O(1)且不做哈希，
+// 遍历即顺序访问连续数组。删除会移动元素，指向元素的指针在删除后失效。非线程安全
+template <typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    ModuleId insert(T value) {
+        uint32_t index;
+        if (free_head_ != kNil) {
+            index = free_head_;
+            free_head_ = slots_[index].position;
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        Slot& slot = slots_[index];
+        ++slot.generation;
+        slot.position = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        owners_.push_back(index);
+        return {index, slot.generation};
+    }
+
+    bool erase(ModuleId id) {
+        if (!contains(id)) {
+            return false;
+        }
+        Slot& slot = slots_[id.index];
+        uint32_t position = slot.position;
+        if (position + 1 != values_.size()) {
+            values_[position] = std::move(values_.back());
+            owners_[position] = owners_.back();
+            slots_[owners_[position]].position = position;
+        }
+        values_.pop_back();
+        owners_.pop_back();
+        ++slot.generation;
+        slot.position = free_head_;
+        free_head_ = id.index;
+        return true;
+    }
+
+    bool contains(ModuleId id) const {
+        return id.index < slots_.size() && (id.generation & 1) && slots_[id.index].generation == id.generation;
+    }
+
+    // 句柄失效时返回nullptr
+    T* get(ModuleId id) { return contains(id) ? &values_[slots_[id.index].position] : nullptr; }
+    const T* get(ModuleId id) const { return contains(id) ? &values_[slots_[id.index].position] : nullptr; }
+
+    // 第position个元素（遍历顺序）的句柄
+    ModuleId idAt(size_t position) const {
+        uint32_t index = owners_[position];
+        return {index, slots_[index].generation};
+    }
+
+    void clear() {
+        for (uint32_t index : owners_) {
+            ++slots_[index].generation;
+            slots_[index].position = free_head_;
+            free_head_ = index;
+        }
+        values_.clear();
+        owners_.clear();
+    }
+
+    void reserve(size_t n) {
+        values_.reserve(n);
+        owners_.reserve(n);
+        slots_.reserve(n);
+    }
+
+    size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    iterator begin() { return values_.begin(); }
+    iterator end() { return values_.end(); }
+    const_iterator begin() const { return values_.begin(); }
+    const_iterator end() const { return values_.end(); }
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t position = kNil;   // 占用时为values_中的下标，空闲时为空闲链表的下一个slot
+    };
+
+    std::vector<T> values_;
+    std::vector<uint32_t> owners_;  // values_[i]所在的slot
+    std::vector<Slot> slots_;
+    uint32_t free_head_ = kNil;
+};
+
+} // namespace ProcessManager
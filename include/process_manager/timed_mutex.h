@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace ProcessManager {
+
+// 锁持有时间的统计，按2的幂纳秒分桶：第0个桶为128ns以下，第i个桶为[2^(i+6), 2^(i+7)) ns，
+// 最后一个桶包含更长的时间
+struct LockStats {
+    static constexpr int kBuckets = 16;
+    uint64_t acquisitions = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    std::array<uint64_t, kBuckets> buckets {};
+
+    static uint64_t bucketUpperNs(int bucket) { return uint64_t(128) << bucket; }
+    // 第p（0~1）分位所在桶的上界
+    uint64_t percentileNs(double p) const;
+};
+
+// 可选地统计持有时间的互斥量，满足Lockable，可直接用于std::lock_guard / std::unique_lock。
+// 未开启统计时只多一次分支；开启后每次加锁、解锁各读一次单调时钟
+class TimedMutex {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void lock() {
+        mutex_.lock();
+        if (enabled_.load(std::memory_order_relaxed)) {
+            acquired_ = Clock::now();
+        }
+    }
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        if (enabled_.load(std::memory_order_relaxed)) {
+            acquired_ = Clock::now();
+        }
+        return true;
+    }
+    void unlock() {
+        if (enabled_.load(std::memory_order_relaxed) && acquired_ != Clock::time_point{}) {
+            record(Clock::now() - acquired_);
+            acquired_ = {};
+        }
+        mutex_.unlock();
+    }
+
+    void enableStats(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    LockStats stats() const;
+    void resetStats();
+
+private:
+    void record(Clock::duration held);
+
+    std::mutex mutex_;
+    std::atomic<bool> enabled_{false};
+    Clock::time_point acquired_ {};     // 只在持有锁时访问
+    std::atomic<uint64_t> acquisitions_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+    std::array<std::atomic<uint64_t>, LockStats::kBuckets> buckets_ {};
+};
+
+} // namespace ProcessManager
@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ProcessManager {
+
+// 分层时间轮：4层，每层64个槽，最小精度为一个tick。
+// 插入、取消均为O(1)；到期回调不在advance内部执行，而是收集给调用者，
+// 这样调用者可以在锁内推进时间轮、在锁外执行回调。非线程安全。
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;
+    static constexpr TimerId kInvalidTimer = 0;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1),
+                        Clock::time_point start = Clock::now());
+
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+    TimerId schedulePeriodic(std::chrono::milliseconds interval, Callback callback);
+    bool cancel(TimerId id);
+
+    // 推进到now，把到期的回调追加到due中，返回到期数量
+    size_t advance(Clock::time_point now, std::vector<Callback>& due);
+
+    // 距离下一次需要advance的时间（毫秒），没有定时器时返回-1
+    // 对高层槽位返回的是其降级时间，是真实到期时间的下界
+    int nextTimeoutMs(Clock::time_point now) const;
+
+    size_t size() const { return active_count_; }
+    bool empty() const { return active_count_ == 0; }
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node {
+        uint64_t expiry = 0;        // 到期tick
+        uint64_t interval = 0;      // 周期（tick），0表示一次性
+        uint32_t generation = 0;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        int16_t level = -1;         // -1表示不在任何槽中
+        int16_t slot = -1;
+        Callback callback;
+    };
+
+    std::chrono::milliseconds tick_;
+    Clock::time_point start_;
+    uint64_t now_tick_ = 0;
+    size_t active_count_ = 0;
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_list_;
+    uint32_t heads_[kLevels][kSlots];
+    uint64_t occupied_[kLevels] = {};   // 每层非空槽位的位图
+
+    uint64_t toTick(Clock::time_point t) const;
+    uint64_t delayTicks(std::chrono::milliseconds delay) const;
+    TimerId add(uint64_t delay_ticks, uint64_t interval, Callback callback);
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(int level);
+    void expireCurrent(std::vector<Callback>& due);
+};
+
+} // namespace ProcessManager
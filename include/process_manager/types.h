@@ -1,27 +1,138 @@
 #pragma once
 #include <unistd.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace ProcessManager {
 
+using CommandArgs = std::vector<std::string>;
+
+// 模块句柄：addModule时分配，模块被移除前保持不变；按句柄访问模块不需要按名字查找。
+// 模块被移除后旧句柄失效（代数不再匹配），即使之后添加了同名模块
+struct ModuleId {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;    // 有效句柄的代数总是奇数
+
+    bool valid() const { return generation != 0; }
+    bool operator==(const ModuleId&) const = default;
+};
+
 enum class ProcessState {
     STOPPED,
     STARTING,
     RUNNING,
     STOPPING,
-    CRASHED
+    CRASHED,    // 已崩溃，等待重启
+    FAILED      // 启动失败且重试无意义（可执行文件不存在、无权限等），不会自动重启
+};
+
+// 模块的健康状态，由外部的健康检查通过ProcessManager::reportHealth上报；
+// 每次启动新进程后恢复为UNKNOWN
+enum class ModuleHealth : uint8_t {
+    UNKNOWN,
+    HEALTHY,
+    UNHEALTHY
+};
+
+// 子进程退出的检测方式
+enum class SupervisorMode {
+    POLLING,    // 定期调用 waitpid(-1, WNOHANG) 轮询
+    EVENT       // 每个子进程一个pidfd，注册到epoll中事件驱动
+};
+
+// 创建子进程的方式
+enum class LaunchBackend {
+    FORK,           // fork + execve，需要复制父进程页表，父进程RSS越大越慢
+    POSIX_SPAWN,    // glibc的posix_spawn（内部为CLONE_VM|CLONE_VFORK）
+    VFORK,          // clone(CLONE_VM|CLONE_VFORK|CLONE_PIDFD)，不复制页表，同时取得pidfd
+    CLONE3          // clone3(CLONE_PIDFD|CLONE_INTO_CGROUP)，原子地取得pidfd并放入cgroup
+};
+
+struct SupervisorOptions {
+    SupervisorMode mode = SupervisorMode::POLLING;
+    std::chrono::milliseconds restart_delay{500};  // 崩溃后重启前的等待时间
+    std::chrono::milliseconds stop_timeout{500};   // SIGTERM后等待多久升级为SIGKILL
+    bool handle_signals = true;  // 接管进程信号；EVENT模式下通过signalfd接入事件循环
+    // 设置PR_SET_CHILD_SUBREAPER：shell包装的模块（bash -c）的孙进程在bash退出后
+    // 过继给管理器而不是init，由管理器归属到原模块、回收并清理
+    bool child_subreaper = false;
+    std::chrono::milliseconds descendant_scan_interval{1000};  // 后代进程索引的增量刷新间隔
+    // 订阅netlink proc connector，实时跟踪模块进程树的fork/exec/exit（仅EVENT模式）。
+    // 需要CAP_NET_ADMIN，不可用时只依赖pidfd
+    bool proc_events = false;
+    // 只回收管理器自己启动的进程（waitid(P_PIDFD)/wait4指定PID），不使用waitpid(-1)，
+    // 嵌入到其他程序中时不会抢走宿主程序（或popen）的子进程
+    bool reap_owned_only = false;
+    LaunchBackend launch_backend = LaunchBackend::FORK;
+    std::string cgroup_path;    // CLONE3后端或zygote：子进程直接创建在该cgroup v2目录中（为空则不使用）
+    // 构造时预先fork一个zygote辅助进程，由它创建子进程（CLONE_PARENT），
+    // 启动延迟与管理器的内存占用无关；zygote不可用时退回launch_backend
+    bool use_zygote = false;
+    size_t launch_threads = 4;  // startModules并行创建子进程的线程数（使用zygote时为1）
+    // 用inotify监视模块的可执行文件及PATH目录（仅EVENT模式）：文件被替换或PATH解析结果变化时
+    // 重建启动计划，之后的启动（包括重启）直接execve新路径
+    bool watch_executables = false;
+    // startModules/startAll在创建进程之前预读各模块的可执行文件及其依赖库（见warmUp）
+    bool warm_up = false;
+    // 统计管理器锁的持有时间（见lockStats），每次加锁、解锁各多读一次时钟
+    bool lock_stats = false;
+};
+
+// 字符串形式的命令如何执行（配置中的shell字段）
+enum class ShellMode {
+    AUTO,       // 内置解释器能处理的直接exec，否则交给 /bin/bash -c
+    ALWAYS,     // 总是 /bin/bash -c
+    NEVER       // 不使用bash：超出内置解释器范围的命令视为无效
+};
+
+// 模块的标准输入输出及额外继承的fd，在命令中的shell重定向之前生效。
+// 除0/1/2和这里列出的fd之外，管理器的其他fd都不会被模块继承
+struct ModuleStdio {
+    // 文件路径：stdin只读打开，stdout/stderr以追加方式创建（/dev/null即丢弃）；为空时继承管理器的
+    std::string stdin_path;
+    std::string stdout_path;
+    std::string stderr_path;
+    bool stderr_to_stdout = false;  // 2>&1
+    // 管理器中已打开的fd（例如管道的一端），dup2为模块的0/1/2，优先于路径；-1表示不使用。
+    // 模块存在期间由调用者保持打开
+    int stdin_fd = -1;
+    int stdout_fd = -1;
+    int stderr_fd = -1;
+    std::vector<int> inherit_fds;   // 以原编号传给模块的其他fd
 };
 
 struct ProcessInfo {
+    ModuleId id;
     std::string name;
-    std::string command;
+    std::string command;        // argv形式添加的模块为以空格连接的argv，仅用于显示
+    CommandArgs argv;           // 以argv形式添加时非空：不经过命令解析，直接exec
+    ShellMode shell = ShellMode::AUTO;
     pid_t pid = -1;
+    int pidfd = -1;
     ProcessState state = ProcessState::STOPPED;
     int restart_count = 0;
     bool auto_restart = true;
+    ModuleStdio stdio;
+    size_t descendants = 0;     // 被跟踪的后代进程数（child_subreaper模式）
+    int orphans_reaped = 0;     // 已回收的过继孤儿进程数（child_subreaper模式）
+    int forks = 0;              // 进程树内的fork次数（proc_events模式）
+    int execs = 0;              // 进程树内的exec次数（proc_events模式）
+    int descendant_exits = 0;   // 后代进程退出次数（proc_events模式）
+    struct rusage last_rusage {};  // 最近一次退出时的资源使用情况
+    int last_error = 0;         // 最近一次启动失败的errno
+    bool binary_replaced = false;  // 进程启动后可执行文件在磁盘上被替换（watch_executables模式）
+    ModuleHealth health = ModuleHealth::UNKNOWN;
 };
 
-using CommandArgs = std::vector<std::string>;
+// startModules中单个模块的启动结果
+struct StartResult {
+    std::string name;
+    bool started = false;
+    pid_t pid = -1;
+    int error = 0;  // 启动失败的errno；模块不存在为ESRCH，已在运行为EALREADY
+};
 
 } // namespace ProcessManager
@@ -0,0 +1,42 @@
+#pragma once
+#include "launch_plan.h"
+#include <sys/types.h>
+#include <atomic>
+#include <mutex>
+#include <optional>
+
+namespace ProcessManager {
+
+// 预先fork的启动辅助进程（zygote）。在管理器内存占用还小时fork一次，
+// 之后通过socketpair接收预编译的启动计划，以CLONE_PARENT|CLONE_PIDFD（vfork，
+// 需要放入cgroup时用clone3）创建子进程：子进程的父进程仍是管理器，pidfd通过SCM_RIGHTS传回，
+// 管理器照常回收和监控。启动延迟不再随管理器的RSS增长。
+class Zygote {
+public:
+    Zygote() = default;
+    ~Zygote();
+
+    Zygote(const Zygote&) = delete;
+    Zygote& operator=(const Zygote&) = delete;
+
+    // cgroup_fd >= 0 时子进程通过CLONE_INTO_CGROUP直接创建在该cgroup中；
+    // new_process_group见LaunchOptions
+    bool start(int cgroup_fd = -1, bool new_process_group = false);
+    void stop();
+    bool isRunning() const { return sock_ != -1; }
+    pid_t pid() const { return pid_; }
+
+    // 语义同ProcessLauncher::launch：失败返回nullopt并设置errno。
+    // zygote已退出时errno为EPIPE/ECONNRESET/ECONNREFUSED，调用者可以退回本地启动；
+    // 其他errno（如EMSGSIZE、ENOBUFS）只表示本次请求失败
+    std::optional<pid_t> launch(const LaunchPlan& plan, int* pidfd = nullptr);
+
+private:
+    [[noreturn]] static void serve(int sock, int cgroup_fd, bool new_process_group);
+
+    std::atomic<int> sock_{-1};   // isRunning可在持锁之外读取
+    pid_t pid_ = -1;
+    std::mutex mutex_;
+};
+
+} // namespace ProcessManager
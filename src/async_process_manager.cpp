@@ -0,0 +1,317 @@
+#include "process_manager/async_process_manager.h"
+#include "process_manager/command_parser.h"
+#include "process_manager/process_launcher.h"
+#include "process_manager/launch_plan.h"
+#include <sys/wait.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <asio/posix/stream_descriptor.hpp>
+#include <async_simple/coro/Collect.h>
+#include "ylt/coro_io/coro_io.hpp"
+#include "ylt/easylog.hpp"
+
+namespace ProcessManager {
+
+namespace {
+// pidfd不可用时检查子进程是否退出的间隔
+constexpr auto kFallbackPollInterval = std::chrono::milliseconds(100);
+}
+
+struct AsyncProcessManager::Module {
+    ProcessInfo info;
+    std::shared_ptr<const LaunchPlan> plan;   // addModule时构建，不可变
+    // 以下成员只在executor线程访问
+    std::unique_ptr<asio::posix::stream_descriptor> pidfd;
+    std::vector<coro_io::period_timer*> exit_waiters;
+    coro_io::period_timer* backoff = nullptr;               // 退避等待重启的定时器，stop时取消
+    std::vector<coro_io::period_timer*> supervise_waiters;  // 等待supervise协程结束
+    bool supervising = false;
+};
+
+AsyncProcessManager::AsyncProcessManager(executor_type executor, std::chrono::milliseconds restart_delay)
+    : executor_(executor), restart_delay_(restart_delay) {}
+
+AsyncProcessManager::~AsyncProcessManager() = default;
+
+bool AsyncProcessManager::addModule(const std::string& name, const std::string& command, bool auto_restart,
+                                    const ModuleStdio& stdio) {
+    ShellCommand compiled = CommandParser::compile(command);
+    if (!CommandParser::validateCommand(compiled.args)) {
+        ELOG_ERROR << "Invalid command for module [" << name << "]";
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (modules_.count(name)) {
+        ELOG_ERROR << "Module [" << name << "] already exists";
+        return false;
+    }
+    
+    auto module = std::make_shared<Module>();
+    module->info.name = name;
+    module->info.command = command;
+    module->info.auto_restart = auto_restart;
+    module->info.stdio = stdio;
+    module->plan = LaunchPlan::build(compiled, stdio);
+    modules_.emplace(name, std::move(module));
+    return true;
+}
+
+std::shared_ptr<AsyncProcessManager::Module> AsyncProcessManager::findModule(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = modules_.find(name);
+    return it != modules_.end() ? it->second : nullptr;
+}
+
+async_simple::coro::Lazy<bool> AsyncProcessManager::start(std::string name) {
+    co_await coro_io::dispatch(executor_.get_asio_executor());
+    
+    auto module = findModule(name);
+    if (!module) {
+        ELOG_ERROR << "Module [" << name << "] not found";
+        co_return false;
+    }
+    if (module->supervising || shutting_down_) {
+        ELOG_ERROR << "Module [" << name << "] already running";
+        co_return false;
+    }
+    if (!launch(*module)) {
+        co_return false;
+    }
+    
+    module->supervising = true;
+    ++supervisors_;
+    supervise(module).via(&executor_).start([](auto&&) {});
+    co_return true;
+}
+
+async_simple::coro::Lazy<bool> AsyncProcessManager::stop(std::string name, std::chrono::milliseconds timeout) {
+    co_await coro_io::dispatch(executor_.get_asio_executor());
+    
+    auto module = findModule(name);
+    if (!module) {
+        co_return false;
+    }
+    
+    pid_t pid;
+    bool backing_off = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (module->info.state == ProcessState::CRASHED) {
+            module->info.state = ProcessState::STOPPED;
+            backing_off = true;
+        }
+        if (!backing_off && module->info.state != ProcessState::RUNNING) {
+            co_return module->info.state != ProcessState::STOPPING;
+        }
+        if (!backing_off) {
+            module->info.state = ProcessState::STOPPING;
+        }
+        pid = module->info.pid;
+    }
+    
+    if (backing_off) {
+        // 正在退避等待重启：取消定时器，等supervise协程结束后才返回，
+        // 之后可以立即重新start，析构时也不会有协程再访问模块
+        if (module->backoff) {
+            module->backoff->cancel();
+        }
+        if (module->supervising) {
+            co_await waitWoken(module->supervise_waiters);
+        }
+        co_return true;
+    }
+    
+    ProcessLauncher::terminate(pid, SIGTERM);
+    if (co_await waitExitFor(*module, timeout)) {
+        co_return true;
+    }
+    
+    ELOG_WARN << "Module [" << name << "] did not exit in " << timeout.count() << "ms, sending SIGKILL";
+    ProcessLauncher::terminate(pid, SIGKILL);
+    co_return co_await waitExitFor(*module, timeout);
+}
+
+async_simple::coro::Lazy<void> AsyncProcessManager::shutdown(std::chrono::milliseconds timeout) {
+    co_await coro_io::dispatch(executor_.get_asio_executor());
+    shutting_down_ = true;
+    ELOG_INFO << "Shutting down async process manager...";
+    
+    std::vector<async_simple::coro::Lazy<bool>> stops;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [name, module] : modules_) {
+            module->info.auto_restart = false;
+            stops.push_back(stop(name, timeout));
+        }
+    }
+    co_await async_simple::coro::collectAll(std::move(stops));
+    // 等待所有supervise协程结束，之后析构管理器是安全的
+    while (supervisors_ > 0) {
+        co_await waitWoken(supervise_waiters_);
+    }
+    
+    ELOG_INFO << "Async process manager shutdown complete";
+}
+
+bool AsyncProcessManager::launch(Module& module) {
+    auto pid = ProcessLauncher::launch(*module.plan);
+    if (!pid) {
+        int err = errno;
+        ELOG_ERROR << "Failed to start module [" << module.info.name << "]: " << std::strerror(err);
+        std::lock_guard<std::mutex> lock(mutex_);
+        module.info.last_error = err;
+        module.info.state = ProcessLauncher::isPermanentError(err) ? ProcessState::FAILED : ProcessState::STOPPED;
+        return false;
+    }
+    
+    int pidfd = ProcessLauncher::openPidfd(*pid);
+    if (pidfd != -1) {
+        module.pidfd = std::make_unique<asio::posix::stream_descriptor>(executor_.get_asio_executor(), pidfd);
+    } else {
+        ELOG_WARN << "pidfd_open failed for PID " << *pid << " (errno " << errno << "), polling instead";
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    module.info.pid = *pid;
+    module.info.pidfd = pidfd;
+    module.info.state = ProcessState::RUNNING;
+    ELOG_INFO << "Started module [" << module.info.name << "] with PID " << *pid;
+    return true;
+}
+
+async_simple::coro::Lazy<int> AsyncProcessManager::waitForExit(Module& module) {
+    pid_t pid = module.info.pid;
+    int status = 0;
+    for (;;) {
+        if (module.pidfd) {
+            co_await coro_io::async_io<std::error_code>(
+                [&](auto&& cb) {
+                    module.pidfd->async_wait(asio::posix::stream_descriptor::wait_read, std::move(cb));
+                },
+                *module.pidfd);
+        } else {
+            co_await coro_io::sleep_for(kFallbackPollInterval, &executor_);
+        }
+        
+        pid_t ret = waitpid(pid, &status, WNOHANG);
+        if (ret == pid) {
+            co_return status;
+        }
+        if (ret == -1 && errno != EINTR) {
+            // 已被其他代码回收，退出状态未知
+            co_return 0;
+        }
+    }
+}
+
+async_simple::coro::Lazy<void> AsyncProcessManager::supervise(std::shared_ptr<Module> module) {
+    for (;;) {
+        int status = co_await waitForExit(*module);
+        module->pidfd.reset();
+        
+        bool restart;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ProcessInfo& info = module->info;
+            ELOG_INFO << "Module [" << info.name << "] with PID " << info.pid << " exited"
+                      << (WIFEXITED(status) ? " with code " + std::to_string(WEXITSTATUS(status)) :
+                          WIFSIGNALED(status) ? " by signal " + std::to_string(WTERMSIG(status)) : "");
+            
+            bool was_stopping = info.state == ProcessState::STOPPING;
+            restart = !shutting_down_ && info.auto_restart && !was_stopping;
+            info.pid = -1;
+            info.pidfd = -1;
+            // CRASHED表示正在退避等待重启
+            info.state = restart ? ProcessState::CRASHED : ProcessState::STOPPED;
+            if (restart) {
+                info.restart_count++;
+                ELOG_INFO << "Auto-restarting module [" << info.name << "] in "
+                          << restart_delay_.count() << "ms (attempt " << info.restart_count << ")";
+            }
+        }
+        notifyExit(*module);
+        
+        if (!restart) {
+            break;
+        }
+        
+        coro_io::period_timer backoff(executor_.get_asio_executor());
+        backoff.expires_after(restart_delay_);
+        module->backoff = &backoff;
+        co_await backoff.async_await();
+        module->backoff = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (module->info.state != ProcessState::CRASHED || shutting_down_) {
+                module->info.state = ProcessState::STOPPED;
+                break;  // 退避期间被stop
+            }
+        }
+        if (!launch(*module)) {
+            break;
+        }
+    }
+    module->supervising = false;
+    wake(module->supervise_waiters);
+    if (--supervisors_ == 0) {
+        wake(supervise_waiters_);
+    }
+}
+
+async_simple::coro::Lazy<bool> AsyncProcessManager::waitExitFor(Module& module, std::chrono::milliseconds timeout) {
+    if (module.info.pid == -1) {
+        co_return true;
+    }
+    
+    coro_io::period_timer timer(executor_.get_asio_executor());
+    timer.expires_after(timeout);
+    module.exit_waiters.push_back(&timer);
+    // 定时器被notifyExit取消表示进程已退出，正常到期表示超时
+    bool timed_out = co_await timer.async_await();
+    std::erase(module.exit_waiters, &timer);
+    co_return !timed_out;
+}
+
+void AsyncProcessManager::notifyExit(Module& module) {
+    wake(module.exit_waiters);
+}
+
+async_simple::coro::Lazy<void> AsyncProcessManager::waitWoken(std::vector<coro_io::period_timer*>& waiters) {
+    coro_io::period_timer timer(executor_.get_asio_executor());
+    timer.expires_at(coro_io::period_timer::time_point::max());
+    waiters.push_back(&timer);
+    co_await timer.async_await();
+    std::erase(waiters, &timer);
+}
+
+void AsyncProcessManager::wake(std::vector<coro_io::period_timer*>& waiters) {
+    auto woken = std::move(waiters);
+    waiters.clear();
+    for (auto* timer : woken) {
+        timer->cancel();
+    }
+}
+
+ProcessState AsyncProcessManager::getModuleState(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = modules_.find(name);
+    return it != modules_.end() ? it->second->info.state : ProcessState::STOPPED;
+}
+
+std::vector<ProcessInfo> AsyncProcessManager::getAllProcesses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ProcessInfo> result;
+    result.reserve(modules_.size());
+    for (const auto& [name, module] : modules_) {
+        result.push_back(module->info);
+    }
+    return result;
+}
+
+bool AsyncProcessManager::isRunning(const std::string& name) const {
+    return getModuleState(name) == ProcessState::RUNNING;
+}
+
+} // namespace ProcessManager
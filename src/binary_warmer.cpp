@@ -0,0 +1,251 @@
+#include "process_manager/binary_warmer.h"
+#include <elf.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace ProcessManager {
+
+namespace {
+
+// 依赖链的最大深度（可执行文件 -> 解释器/库 -> 库 ...）
+constexpr int kMaxDepth = 16;
+// 动态段和字符串表的读取上限，防止损坏的文件导致大量读取
+constexpr size_t kMaxDynamicBytes = 1 << 20;
+
+bool readAt(int fd, void* buf, size_t size, off_t offset) {
+    return pread(fd, buf, size, offset) == static_cast<ssize_t>(size);
+}
+
+std::string dirName(const std::string& path) {
+    size_t slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+void splitInto(const std::string& list, const std::string& origin, std::vector<std::string>& out) {
+    std::stringstream ss(list);
+    std::string dir;
+    while (std::getline(ss, dir, ':')) {
+        if (dir.empty()) {
+            continue;
+        }
+        for (const char* token : {"${ORIGIN}", "$ORIGIN"}) {
+            size_t pos = dir.find(token);
+            if (pos != std::string::npos) {
+                dir.replace(pos, std::strlen(token), origin);
+            }
+        }
+        out.push_back(dir);
+    }
+}
+
+void loadLdConf(const std::string& file, std::vector<std::string>& dirs, int depth) {
+    std::ifstream in(file);
+    std::string line;
+    while (depth < kMaxDepth && std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos) {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t");
+        line = line.substr(begin, end - begin + 1);
+        if (line.compare(0, 8, "include ") != 0) {
+            dirs.push_back(line);
+            continue;
+        }
+        std::string pattern = line.substr(line.find_first_not_of(" \t", 8));
+        if (pattern.front() != '/') {
+            pattern = dirName(file) + "/" + pattern;
+        }
+        glob_t matches;
+        if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i) {
+                loadLdConf(matches.gl_pathv[i], dirs, depth + 1);
+            }
+        }
+        globfree(&matches);
+    }
+}
+
+} // namespace
+
+int BinaryWarmer::warm(const std::string& path, const std::string& cwd) {
+    std::string full = path.empty() || path.front() == '/' || cwd.empty() ? path : cwd + "/" + path;
+    if (!prefetch(full, 0)) {
+        return -1;
+    }
+    return open(full.c_str(), O_PATH | O_CLOEXEC);
+}
+
+bool BinaryWarmer::prefetch(const std::string& path, int depth) {
+    auto known = seen_.find(path);
+    if (known != seen_.end()) {
+        return known->second;
+    }
+    seen_[path] = false;
+    if (depth > kMaxDepth) {
+        return false;
+    }
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    char magic[SELFMAG] = {};
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || !readAt(fd, magic, sizeof(magic), 0)) {
+        close(fd);
+        return false;
+    }
+    bool elf = std::memcmp(magic, ELFMAG, SELFMAG) == 0;
+    seen_[path] = elf;
+    if (!seen_files_.emplace(st.st_dev, st.st_ino).second) {
+        close(fd);
+        return elf;     // 经由其他路径（符号链接）已经预热过
+    }
+    
+    // 只是发起预读，不等待I/O完成，多个文件的读取由内核并行进行
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    paths_.push_back(path);
+    bytes_ += st.st_size;
+
+    if (elf) {
+        prefetchNeeded(fd, path, depth);
+    } else if (magic[0] == '#' && magic[1] == '!') {
+        // 脚本：预热#!行中的解释器
+        char line[256] = {};
+        if (pread(fd, line, sizeof(line) - 1, 2) <= 0) {
+            line[0] = '\0';
+        }
+        std::string interpreter(line, std::strcspn(line, "\n"));
+        size_t begin = interpreter.find_first_not_of(" \t");
+        if (begin != std::string::npos) {
+            interpreter = interpreter.substr(begin, interpreter.find_first_of(" \t", begin) - begin);
+            prefetch(interpreter, depth + 1);
+        }
+    }
+    close(fd);
+    return elf;
+}
+
+void BinaryWarmer::prefetchNeeded(int fd, const std::string& path, int depth) {
+    Elf64_Ehdr header;
+    if (!readAt(fd, &header, sizeof(header), 0) || header.e_ident[EI_CLASS] != ELFCLASS64 ||
+        header.e_phentsize != sizeof(Elf64_Phdr) || header.e_phnum == 0) {
+        return;
+    }
+    std::vector<Elf64_Phdr> segments(header.e_phnum);
+    if (!readAt(fd, segments.data(), segments.size() * sizeof(Elf64_Phdr), header.e_phoff)) {
+        return;
+    }
+
+    const Elf64_Phdr* dynamic = nullptr;
+    for (const auto& segment : segments) {
+        if (segment.p_type == PT_INTERP && segment.p_filesz > 1 && segment.p_filesz < 4096) {
+            std::string interpreter(segment.p_filesz, '\0');
+            if (readAt(fd, interpreter.data(), interpreter.size(), segment.p_offset)) {
+                prefetch(interpreter.c_str(), depth + 1);
+            }
+        } else if (segment.p_type == PT_DYNAMIC) {
+            dynamic = &segment;
+        }
+    }
+    if (!dynamic || dynamic->p_filesz > kMaxDynamicBytes) {
+        return;
+    }
+
+    std::vector<Elf64_Dyn> entries(dynamic->p_filesz / sizeof(Elf64_Dyn));
+    if (!readAt(fd, entries.data(), entries.size() * sizeof(Elf64_Dyn), dynamic->p_offset)) {
+        return;
+    }
+    Elf64_Addr strtab = 0;
+    Elf64_Xword strsz = 0;
+    std::vector<Elf64_Xword> needed;
+    Elf64_Xword rpath = 0, runpath = 0;
+    bool has_rpath = false, has_runpath = false;
+    for (const auto& entry : entries) {
+        switch (entry.d_tag) {
+            case DT_NEEDED: needed.push_back(entry.d_un.d_val); break;
+            case DT_STRTAB: strtab = entry.d_un.d_ptr; break;
+            case DT_STRSZ: strsz = entry.d_un.d_val; break;
+            case DT_RPATH: rpath = entry.d_un.d_val; has_rpath = true; break;
+            case DT_RUNPATH: runpath = entry.d_un.d_val; has_runpath = true; break;
+            default: break;
+        }
+    }
+    if (needed.empty() || strsz == 0 || strsz > kMaxDynamicBytes) {
+        return;
+    }
+
+    // DT_STRTAB是虚拟地址，按PT_LOAD段换算为文件偏移
+    off_t strtab_offset = -1;
+    for (const auto& segment : segments) {
+        if (segment.p_type == PT_LOAD && strtab >= segment.p_vaddr && strtab < segment.p_vaddr + segment.p_filesz) {
+            strtab_offset = static_cast<off_t>(strtab - segment.p_vaddr + segment.p_offset);
+            break;
+        }
+    }
+    std::string strings(strsz, '\0');
+    if (strtab_offset < 0 || !readAt(fd, strings.data(), strings.size(), strtab_offset)) {
+        return;
+    }
+    auto stringAt = [&strings](Elf64_Xword offset) {
+        return offset < strings.size() ? std::string(strings.c_str() + offset) : std::string();
+    };
+
+    // 查找顺序近似ld.so：RPATH（无RUNPATH时）、LD_LIBRARY_PATH、RUNPATH、系统目录
+    std::string origin = dirName(path);
+    std::vector<std::string> search_dirs;
+    if (has_rpath && !has_runpath) {
+        splitInto(stringAt(rpath), origin, search_dirs);
+    }
+    if (const char* library_path = getenv("LD_LIBRARY_PATH")) {
+        splitInto(library_path, origin, search_dirs);
+    }
+    if (has_runpath) {
+        splitInto(stringAt(runpath), origin, search_dirs);
+    }
+    for (Elf64_Xword offset : needed) {
+        std::string name = stringAt(offset);
+        if (name.empty()) {
+            continue;
+        }
+        std::string library = name.find('/') != std::string::npos ? name : findLibrary(name, search_dirs);
+        if (!library.empty()) {
+            prefetch(library, depth + 1);
+        }
+    }
+}
+
+std::string BinaryWarmer::findLibrary(const std::string& name, const std::vector<std::string>& search_dirs) {
+    for (const auto* dirs : {&search_dirs, &systemLibraryDirs()}) {
+        for (const auto& dir : *dirs) {
+            std::string candidate = dir + "/" + name;
+            if (access(candidate.c_str(), R_OK) == 0) {
+                return candidate;
+            }
+        }
+    }
+    return {};
+}
+
+const std::vector<std::string>& BinaryWarmer::systemLibraryDirs() {
+    if (!system_dirs_loaded_) {
+        system_dirs_loaded_ = true;
+        loadLdConf("/etc/ld.so.conf", system_dirs_, 0);
+        for (const char* dir : {"/lib64", "/usr/lib64", "/lib", "/usr/lib"}) {
+            system_dirs_.push_back(dir);
+        }
+    }
+    return system_dirs_;
+}
+
+} // namespace ProcessManager
@@ -1,66 +1,852 @@
 #include "process_manager/command_parser.h"
+#include <fcntl.h>
+#include <unistd.h>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
+#include <array>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
 
 namespace ProcessManager {
 
-CommandArgs CommandParser::parseCommand(const std::string& command_line) {
-    // 检查是否包含shell语法
-    if (needsShell(command_line)) {
-        return {"/bin/bash", "-c", command_line};
+namespace {
+
+// source嵌套的最大深度
+constexpr int kMaxSourceDepth = 8;
+
+// 作为命令名时必须交给bash的保留字和内置命令（没有同名的可执行文件或语义不同）
+constexpr std::string_view kShellOnly[] = {
+    "{", "}", "!", "[[", "]]", "if", "then", "else", "elif", "fi", "case", "esac", "for", "while",
+    "until", "do", "done", "function", "select", "time", "coproc", "alias", "bg", "break", "builtin",
+    "command", "continue", "declare", "eval", "exit", "fg", "jobs", "let", "local", "readonly",
+    "return", "set", "shift", "trap", "typeset", "ulimit", "umask", "wait",
+};
+
+// 由解释器处理的内置命令，作为命令名时不能直接exec
+constexpr std::string_view kBuiltins[] = {"cd", "export", "unset", "source", ".", ":", "exec"};
+
+// 命令分类用的字符类别
+enum CharClass : uint8_t {
+    kBlank = 1 << 0,        // 空格、制表符：分隔词
+    kOperator = 1 << 1,     // ; & | < > ( ) 换行
+    kExpansion = 1 << 2,    // $ `
+    kPattern = 1 << 3,      // * ? [ {：通配符和花括号展开
+    kWordStart = 1 << 4,    // # ~：只在词首有特殊含义（注释、家目录）
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses() {
+    std::array<uint8_t, 256> classes{};
+    for (char c : std::string_view(" \t")) {
+        classes[static_cast<unsigned char>(c)] |= kBlank;
     }
+    for (char c : std::string_view(";&|<>()\n")) {
+        classes[static_cast<unsigned char>(c)] |= kOperator;
+    }
+    for (char c : std::string_view("$`")) {
+        classes[static_cast<unsigned char>(c)] |= kExpansion;
+    }
+    for (char c : std::string_view("*?[{")) {
+        classes[static_cast<unsigned char>(c)] |= kPattern;
+    }
+    for (char c : std::string_view("#~")) {
+        classes[static_cast<unsigned char>(c)] |= kWordStart;
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> kCharClass = makeCharClasses();
+constexpr uint8_t kNeedsShell = kOperator | kExpansion | kPattern;
+
+enum class TokenType { WORD, AND_IF, SEMI, REDIRECT };
+
+struct Token {
+    TokenType type;
+    std::string text;       // WORD：原始文本（含引号，展开在执行时进行）；REDIRECT：运算符
+    int io_number = -1;     // REDIRECT之前的fd编号（2>file中的2）
+};
+
+struct SimpleCommand {
+    std::vector<std::string> words;
+    std::vector<std::pair<Token, std::string>> redirects;  // 运算符和目标词
+};
+
+struct ShellState {
+    std::string cwd;
+    std::vector<std::string> env;                         // NAME=VALUE
+    std::unordered_map<std::string, std::string> vars;    // 未导出的shell变量
+    bool env_changed = false;
+    int depth = 0;
+};
+
+bool isNameStart(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+bool isNameChar(char c) {
+    return isNameStart(c) || (c >= '0' && c <= '9');
+}
+
+bool isName(std::string_view s) {
+    return !s.empty() && isNameStart(s[0]) && std::all_of(s.begin(), s.end(), isNameChar);
+}
+
+bool isDigits(std::string_view s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+// NAME=... 形式的赋值词（名字部分不含引号）
+bool isAssignment(std::string_view word) {
+    size_t eq = word.find('=');
+    return eq != std::string_view::npos && isName(word.substr(0, eq));
+}
+
+bool isShellOnly(std::string_view name) {
+    return std::find(std::begin(kShellOnly), std::end(kShellOnly), name) != std::end(kShellOnly);
+}
+
+bool isBuiltin(std::string_view name) {
+    return std::find(std::begin(kBuiltins), std::end(kBuiltins), name) != std::end(kBuiltins);
+}
+
+// 单遍扫描命令行，同时完成POSIX的引号去除：单引号内全部按字面；双引号内只有反斜杠后跟
+// $ ` " \ 或换行时是转义；引号外的反斜杠转义下一个字符（反斜杠换行为续行）；相邻的片段拼成一个词，
+// ""是一个空参数。未加引号的运算符、通配符、词首的#和~、=或:之后的~（bash对赋值形式的参数
+// 也做波浪号展开），以及任何$、`都需要shell；命令名是关键字、内置命令或赋值时也需要shell。
+// 返回是否需要shell；args非空时同时收集词（需要shell时内容不完整）。
+// args为空时不构造词、不分配内存：命令名放在栈上的小缓冲区中与关键字、内置命令比较，
+// 是否为赋值在扫描时逐字符判断
+bool classify(std::string_view line, CommandArgs* args) {
+    std::string word;
+    bool in_word = false;
+    bool command_name = true;
+    constexpr size_t kMaxName = 16;     // 长于此的词不可能是关键字或内置命令
+    char name[kMaxName];
+    size_t name_len = 0;
+    bool name_ok = false;               // 第一个=之前都是变量名字符
+    bool assignment = false;
+    auto append = [&](char c) {
+        in_word = true;
+        if (args) {
+            word += c;
+        }
+        if (!command_name) {
+            return;
+        }
+        if (name_len < kMaxName) {
+            name[name_len] = c;
+        }
+        if (!assignment && name_ok && c == '=') {
+            assignment = true;
+        }
+        name_ok = name_len == 0 ? isNameStart(c) : name_ok && isNameChar(c);
+        ++name_len;
+    };
+    auto endWord = [&] {
+        in_word = false;
+        if (command_name) {
+            std::string_view command(name, std::min(name_len, kMaxName));
+            if (assignment || (name_len <= kMaxName && (isShellOnly(command) || isBuiltin(command)))) {
+                return true;
+            }
+            command_name = false;
+        }
+        if (args) {
+            args->push_back(word);
+            word.clear();
+        }
+        return false;
+    };
     
-    // 普通命令解析
-    CommandArgs tokens;
-    std::string current_token;
-    bool in_quotes = false;
-    bool in_single_quotes = false;
-    bool escaped = false;
-    
-    for (size_t i = 0; i < command_line.length(); ++i) {
-        char c = command_line[i];
-        
-        if (escaped) {
-            current_token += c;
-            escaped = false;
+    size_t n = line.size();
+    for (size_t i = 0; i < n; ++i) {
+        char c = line[i];
+        uint8_t cls = kCharClass[static_cast<unsigned char>(c)];
+        if (cls & kBlank) {
+            if (in_word && endWord()) {
+                return true;
+            }
+        } else if (c == '\\') {
+            if (++i >= n) {
+                return true;
+            }
+            if (line[i] != '\n') {
+                append(line[i]);
+            }
+        } else if (c == '\'') {
+            size_t close = line.find('\'', i + 1);
+            if (close == std::string_view::npos) {
+                return true;
+            }
+            std::string_view quoted = line.substr(i + 1, close - i - 1);
+            if (command_name) {
+                for (char q : quoted) {
+                    append(q);
+                }
+            } else if (args) {
+                word.append(quoted);
+            }
+            in_word = true;
+            i = close;
+        } else if (c == '"') {
+            for (++i; i < n && line[i] != '"'; ++i) {
+                char q = line[i];
+                if (q == '$' || q == '`') {
+                    return true;
+                }
+                if (q == '\\' && i + 1 < n && std::string_view("$`\"\\\n").find(line[i + 1]) != std::string_view::npos) {
+                    if (line[++i] != '\n') {
+                        append(line[i]);
+                    }
+                    continue;
+                }
+                append(q);
+            }
+            if (i >= n) {
+                return true;
+            }
+            in_word = true;
+        } else if ((cls & kNeedsShell) || (!in_word && (cls & kWordStart)) ||
+                   (c == '~' && (line[i - 1] == '=' || line[i - 1] == ':'))) {
+            return true;
+        } else {
+            append(c);
+        }
+    }
+    return in_word && endWord();
+}
+
+std::vector<std::string>::iterator findEnv(std::vector<std::string>& env, std::string_view name) {
+    return std::find_if(env.begin(), env.end(), [name](const std::string& entry) {
+        return entry.size() > name.size() && entry[name.size()] == '=' && entry.compare(0, name.size(), name) == 0;
+    });
+}
+
+void setEnv(ShellState& state, const std::string& name, const std::string& value) {
+    auto it = findEnv(state.env, name);
+    if (it != state.env.end()) {
+        *it = name + "=" + value;
+    } else {
+        state.env.push_back(name + "=" + value);
+    }
+    state.vars.erase(name);
+    state.env_changed = true;
+}
+
+std::optional<std::string> getVar(ShellState& state, const std::string& name) {
+    auto var = state.vars.find(name);
+    if (var != state.vars.end()) {
+        return var->second;
+    }
+    auto it = findEnv(state.env, name);
+    if (it != state.env.end()) {
+        return it->substr(name.size() + 1);
+    }
+    return std::nullopt;
+}
+
+// 赋值：已导出的变量更新环境，否则只是shell变量
+void assign(ShellState& state, const std::string& name, const std::string& value) {
+    if (findEnv(state.env, name) != state.env.end()) {
+        setEnv(state, name, value);
+    } else {
+        state.vars[name] = value;
+    }
+}
+
+// 把命令行切分为词和运算符；引号和转义只用于确定词边界。遇到不支持的语法返回false
+bool lex(const std::string& line, std::vector<Token>& tokens) {
+    size_t i = 0;
+    size_t n = line.size();
+    int io_number = -1;
+    while (i < n) {
+        char c = line[i];
+        if (c == ' ' || c == '\t') {
+            ++i;
+            continue;
+        }
+        if (c == '\\' && i + 1 < n && line[i + 1] == '\n') {
+            i += 2;
+            continue;
+        }
+        if (c == '#') {
+            while (i < n && line[i] != '\n') {
+                ++i;
+            }
+            continue;
+        }
+        if (c == '\n' || c == ';') {
+            if (c == ';' && i + 1 < n && line[i + 1] == ';') {
+                return false;
+            }
+            tokens.push_back({TokenType::SEMI, ";"});
+            ++i;
+            continue;
+        }
+        if (c == '&') {
+            if (i + 1 < n && line[i + 1] == '&') {
+                tokens.push_back({TokenType::AND_IF, "&&"});
+                i += 2;
+            } else if (i + 1 < n && line[i + 1] == '>' && io_number == -1) {
+                bool append = i + 2 < n && line[i + 2] == '>';
+                tokens.push_back({TokenType::REDIRECT, append ? "&>>" : "&>"});
+                i += append ? 3 : 2;
+            } else {
+                return false;   // 后台运行
+            }
+            continue;
+        }
+        if (c == '|' || c == '(' || c == ')' || c == '`') {
+            return false;
+        }
+        if (c == '<' || c == '>') {
+            std::string op(1, c);
+            char next = i + 1 < n ? line[i + 1] : '\0';
+            if (next == '&' || (c == '>' && (next == '>' || next == '|'))) {
+                op += next;
+            } else if (next == '<' || (c == '<' && next == '>')) {
+                return false;   // here-doc、<>
+            }
+            i += op.size();
+            if (op == ">|") {
+                op = ">";
+            }
+            tokens.push_back({TokenType::REDIRECT, op, io_number});
+            io_number = -1;
             continue;
         }
         
+        size_t start = i;
+        while (i < n) {
+            c = line[i];
+            if (c == '\\') {
+                i += 2;
+            } else if (c == '\'') {
+                size_t close = line.find('\'', i + 1);
+                if (close == std::string::npos) {
+                    return false;
+                }
+                i = close + 1;
+            } else if (c == '"') {
+                for (++i; i < n && line[i] != '"'; ++i) {
+                    if (line[i] == '\\') {
+                        ++i;
+                    }
+                }
+                if (i >= n) {
+                    return false;
+                }
+                ++i;
+            } else if (c == '$' && i + 1 < n && line[i + 1] == '{') {
+                size_t close = line.find('}', i);
+                if (close == std::string::npos) {
+                    return false;
+                }
+                i = close + 1;
+            } else if (isBlank(c) || std::string_view(";&|<>()`").find(c) != std::string_view::npos) {
+                break;
+            } else {
+                ++i;
+            }
+        }
+        std::string word = line.substr(start, std::min(i, n) - start);
+        if (i < n && (line[i] == '<' || line[i] == '>') && isDigits(word) && word.size() < 4) {
+            io_number = std::stoi(word);
+            continue;
+        }
+        tokens.push_back({TokenType::WORD, std::move(word)});
+    }
+    return true;
+}
+
+// 读取$之后的变量名。返回-1表示不支持的展开（位置参数、特殊变量、${VAR:-x}等），
+// 0表示$按字面处理，1表示取得了变量名；i移到展开之后
+int readVarName(const std::string& word, size_t& i, std::string& name) {
+    size_t n = word.size();
+    if (i + 1 >= n) {
+        return 0;
+    }
+    char next = word[i + 1];
+    if (next == '{') {
+        size_t close = word.find('}', i);
+        if (close == std::string::npos || !isName(std::string_view(word).substr(i + 2, close - i - 2))) {
+            return -1;
+        }
+        name = word.substr(i + 2, close - i - 2);
+        i = close + 1;
+        return 1;
+    }
+    if (isNameStart(next)) {
+        size_t end = i + 1;
+        while (end < n && isNameChar(word[end])) {
+            ++end;
+        }
+        name = word.substr(i + 1, end - i - 1);
+        i = end;
+        return 1;
+    }
+    if ((next >= '0' && next <= '9') || std::string_view("@*#?$!-(").find(next) != std::string_view::npos) {
+        return -1;
+    }
+    return 0;
+}
+
+// 展开一个词：引号去除、反斜杠转义、$VAR/${VAR}、开头的~。
+// split为true时（普通参数）未加引号的展开结果按空白分词；为false时（赋值、重定向目标）结果为一个字段。
+// 未加引号的通配符、花括号、$'...'、$"..."，以及除参数开头的~和~/之外的~（~user、
+// 赋值中的~）都不支持，返回false交给bash
+bool expandWord(const std::string& word, ShellState& state, bool split, std::vector<std::string>& fields) {
+    std::string field;
+    bool have = false;
+    auto flush = [&] {
+        if (have) {
+            fields.push_back(std::move(field));
+            field.clear();
+            have = false;
+        }
+    };
+    auto expandVar = [&](size_t& i, std::string& value) {
+        std::string name;
+        int found = readVarName(word, i, name);
+        if (found == 1) {
+            value = getVar(state, name).value_or("");
+        } else if (found == 0) {
+            value = "$";
+            ++i;
+        }
+        return found;
+    };
+    
+    size_t n = word.size();
+    size_t i = 0;
+    if (split && !word.empty() && word[0] == '~' && (n == 1 || word[1] == '/')) {
+        auto home = getVar(state, "HOME");
+        if (!home) {
+            return false;
+        }
+        field = *home;
+        have = true;
+        i = 1;
+    }
+    while (i < n) {
+        char c = word[i];
         if (c == '\\') {
-            escaped = true;
-            current_token += c;
+            if (i + 1 < n) {
+                field += word[i + 1];
+            }
+            have = true;
+            i += 2;
+        } else if (c == '\'') {
+            size_t close = word.find('\'', i + 1);
+            field.append(word, i + 1, close - i - 1);
+            have = true;
+            i = close + 1;
+        } else if (c == '"') {
+            have = true;
+            for (++i; i < n && word[i] != '"';) {
+                c = word[i];
+                if (c == '\\' && i + 1 < n && std::string_view("$`\"\\\n").find(word[i + 1]) != std::string_view::npos) {
+                    if (word[i + 1] != '\n') {
+                        field += word[i + 1];
+                    }
+                    i += 2;
+                } else if (c == '$') {
+                    std::string value;
+                    if (expandVar(i, value) < 0) {
+                        return false;
+                    }
+                    field += value;
+                } else if (c == '`') {
+                    return false;
+                } else {
+                    field += c;
+                    ++i;
+                }
+            }
+            ++i;
+        } else if (c == '$') {
+            if (i + 1 < n && (word[i + 1] == '\'' || word[i + 1] == '"')) {
+                return false;   // ANSI-C引号、本地化字符串
+            }
+            std::string value;
+            int found = expandVar(i, value);
+            if (found < 0) {
+                return false;
+            }
+            if (!split || found == 0) {
+                field += value;
+                have = true;
+                continue;
+            }
+            for (char v : value) {
+                if (isBlank(v)) {
+                    flush();
+                } else {
+                    field += v;
+                    have = true;
+                }
+            }
+        } else if ((split && (c == '*' || c == '?' || c == '[')) || c == '{' || c == '~') {
+            return false;   // 通配符、花括号展开、波浪号展开
+        } else {
+            field += c;
+            have = true;
+            ++i;
+        }
+    }
+    if (!split) {
+        have = true;
+    }
+    flush();
+    return true;
+}
+
+// 命令行中是否有词（只有空白和注释的命令什么也不执行）
+bool hasWords(const std::string& line) {
+    std::vector<Token> tokens;
+    if (!lex(line, tokens)) {
+        return true;    // 含有解释器不支持的语法
+    }
+    return std::any_of(tokens.begin(), tokens.end(), [](const Token& token) { return token.type != TokenType::SEMI; });
+}
+
+bool expandSingle(const std::string& word, ShellState& state, std::string& out) {
+    std::vector<std::string> fields;
+    if (!expandWord(word, state, false, fields)) {
+        return false;
+    }
+    out = fields.empty() ? std::string() : std::move(fields[0]);
+    return true;
+}
+
+bool expandAll(const std::vector<std::string>& words, size_t begin, ShellState& state,
+               std::vector<std::string>& out) {
+    for (size_t i = begin; i < words.size(); ++i) {
+        if (!expandWord(words[i], state, true, out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 按 && 和 ; 拆分为简单命令
+bool parse(const std::vector<Token>& tokens, std::vector<SimpleCommand>& commands) {
+    SimpleCommand current;
+    bool after_and = false;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token& token = tokens[i];
+        if (token.type == TokenType::WORD) {
+            current.words.push_back(token.text);
+        } else if (token.type == TokenType::REDIRECT) {
+            if (i + 1 >= tokens.size() || tokens[i + 1].type != TokenType::WORD) {
+                return false;
+            }
+            current.redirects.emplace_back(token, tokens[++i].text);
+        } else {
+            bool empty = current.words.empty() && current.redirects.empty();
+            if (empty && (token.type == TokenType::AND_IF || after_and)) {
+                return false;
+            }
+            if (!empty) {
+                commands.push_back(std::move(current));
+                current = {};
+            }
+            after_and = token.type == TokenType::AND_IF;
+        }
+    }
+    if (current.words.empty() && current.redirects.empty()) {
+        return !after_and;
+    }
+    commands.push_back(std::move(current));
+    return true;
+}
+
+// 词法上规范化路径（与shell的逻辑cd一致，不解析符号链接）
+std::string normalizePath(const std::string& base, const std::string& path) {
+    std::string joined = path.front() == '/' ? path : base + "/" + path;
+    std::vector<std::string> parts;
+    std::stringstream ss(joined);
+    std::string part;
+    while (std::getline(ss, part, '/')) {
+        if (part.empty() || part == ".") {
             continue;
         }
-        
-        if (c == '"' && !in_single_quotes) {
-            in_quotes = !in_quotes;
-            // 保留引号在token中
-            current_token += c;
+        if (part == "..") {
+            if (!parts.empty()) {
+                parts.pop_back();
+            }
+        } else {
+            parts.push_back(part);
+        }
+    }
+    std::string result;
+    for (const auto& p : parts) {
+        result += "/" + p;
+    }
+    return result.empty() ? "/" : result;
+}
+
+bool interpret(const std::string& script, ShellState& state, ShellCommand* final_command);
+
+// 执行cd、export、unset、source/.等内置命令，其他命令返回false
+bool runBuiltin(const std::string& name, const std::vector<std::string>& args, ShellState& state) {
+    if (name == ":" || name == "true") {
+        return true;
+    }
+    if (name == "cd") {
+        std::string dir;
+        if (args.empty()) {
+            auto home = getVar(state, "HOME");
+            if (!home || home->empty()) {
+                return false;
+            }
+            dir = *home;
+        } else if (args.size() == 1 && !args[0].empty() && args[0] != "-") {
+            dir = args[0];
+        } else {
+            return false;
+        }
+        std::string base = state.cwd;
+        if (base.empty()) {
+            char buf[4096];
+            if (!getcwd(buf, sizeof(buf))) {
+                return false;
+            }
+            base = buf;
+        }
+        state.cwd = normalizePath(base, dir);
+        setEnv(state, "OLDPWD", base);
+        setEnv(state, "PWD", state.cwd);
+        return true;
+    }
+    if (name == "export" || name == "unset") {
+        for (const auto& arg : args) {
+            if (!arg.empty() && arg[0] == '-') {
+                return false;
+            }
+        }
+        for (const auto& arg : args) {
+            size_t eq = arg.find('=');
+            std::string var = arg.substr(0, eq);
+            if (!isName(var) || (name == "unset" && eq != std::string::npos)) {
+                return false;
+            }
+            if (name == "unset") {
+                auto it = findEnv(state.env, var);
+                if (it != state.env.end()) {
+                    state.env.erase(it);
+                    state.env_changed = true;
+                }
+                state.vars.erase(var);
+            } else if (eq != std::string::npos) {
+                setEnv(state, var, arg.substr(eq + 1));
+            } else if (auto value = getVar(state, var)) {
+                setEnv(state, var, *value);
+            }
+        }
+        return true;
+    }
+    if (name == "source" || name == ".") {
+        // 在编译时读取：只允许其中包含赋值、export等同样受支持的内置命令
+        if (args.size() != 1 || state.depth >= kMaxSourceDepth) {
+            return false;
+        }
+        std::string path = args[0];
+        if (path.find('/') == std::string::npos || path.front() != '/') {
+            path = (state.cwd.empty() ? "." : state.cwd) + "/" + path;
+        }
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        ++state.depth;
+        bool ok = interpret(content.str(), state, nullptr);
+        --state.depth;
+        return ok;
+    }
+    return false;
+}
+
+bool applyRedirects(const SimpleCommand& command, ShellState& state, std::vector<Redirect>& redirects) {
+    for (const auto& [token, word] : command.redirects) {
+        const std::string& op = token.text;
+        std::string target;
+        if (!expandSingle(word, state, target) || target.empty()) {
+            return false;
+        }
+        Redirect redirect;
+        if (op == ">&" || op == "<&") {
+            redirect.target = token.io_number != -1 ? token.io_number : (op == ">&" ? 1 : 0);
+            if (target == "-") {
+                redirect.source = -1;
+            } else if (isDigits(target) && target.size() < 4) {
+                redirect.source = std::stoi(target);
+            } else {
+                return false;   // >&file
+            }
+            redirects.push_back(std::move(redirect));
             continue;
         }
+        if (op == "<") {
+            redirect.target = token.io_number != -1 ? token.io_number : 0;
+            redirect.open_flags = O_RDONLY;
+        } else {
+            redirect.target = token.io_number != -1 ? token.io_number : 1;
+            bool append = op == ">>" || op == "&>>";
+            redirect.open_flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+        }
+        redirect.path = std::move(target);
+        redirects.push_back(std::move(redirect));
+        if (op[0] == '&') {
+            redirects.push_back(Redirect{2, 1, 0, {}});   // &>file 等同于 >file 2>&1
+        }
+    }
+    return true;
+}
+
+// 依次执行脚本中的命令。final_command非空时最后一条必须是要exec的外部命令，
+// 编译到final_command中；为空时（source的文件）只允许内置命令
+bool interpret(const std::string& script, ShellState& state, ShellCommand* final_command) {
+    std::vector<Token> tokens;
+    std::vector<SimpleCommand> commands;
+    if (!lex(script, tokens) || !parse(tokens, commands)) {
+        return false;
+    }
+    if (final_command && commands.empty()) {
+        return false;
+    }
+    
+    for (size_t c = 0; c < commands.size(); ++c) {
+        const SimpleCommand& command = commands[c];
+        bool is_final = final_command && c + 1 == commands.size();
+        size_t first = 0;
+        while (first < command.words.size() && isAssignment(command.words[first])) {
+            ++first;
+        }
         
-        if (c == '\'' && !in_quotes) {
-            in_single_quotes = !in_single_quotes;
-            // 保留引号在token中
-            current_token += c;
+        // 先在赋值生效前展开命令词（与shell的 A=1 cmd $A 一致）
+        std::vector<std::string> words;
+        if (!expandAll(command.words, first, state, words)) {
+            return false;
+        }
+        std::vector<std::pair<std::string, std::string>> assignments;
+        for (size_t i = 0; i < first; ++i) {
+            const std::string& word = command.words[i];
+            size_t eq = word.find('=');
+            std::string value;
+            if (!expandSingle(word.substr(eq + 1), state, value)) {
+                return false;
+            }
+            assignments.emplace_back(word.substr(0, eq), std::move(value));
+        }
+        
+        if (words.empty()) {
+            // 单独的赋值
+            if (is_final || !command.redirects.empty()) {
+                return false;
+            }
+            for (const auto& [name, value] : assignments) {
+                assign(state, name, value);
+            }
+            continue;
+        }
+        if (isShellOnly(words[0])) {
+            return false;
+        }
+        if (!is_final) {
+            if (!assignments.empty() || !command.redirects.empty()) {
+                return false;
+            }
+            if (!runBuiltin(words[0], std::vector<std::string>(words.begin() + 1, words.end()), state)) {
+                return false;
+            }
             continue;
         }
         
-        if ((c == ' ' || c == '\t') && !in_quotes && !in_single_quotes) {
-            if (!current_token.empty()) {
-                tokens.push_back(current_token);
-                current_token.clear();
+        if (words[0] == "exec") {
+            words.erase(words.begin());
+            if (words.empty() || words[0].front() == '-') {
+                return false;
             }
-        } else {
-            current_token += c;
         }
+        if (words[0] == "cd" || words[0] == "export" || words[0] == "unset" || words[0] == "source" ||
+            words[0] == "." || words[0] == ":") {
+            return false;
+        }
+        if (!applyRedirects(command, state, final_command->redirects)) {
+            return false;
+        }
+        // VAR=val cmd：只对该命令生效，总是进入它的环境
+        for (const auto& [name, value] : assignments) {
+            setEnv(state, name, value);
+        }
+        final_command->args = std::move(words);
+    }
+    return true;
+}
+
+} // namespace
+
+CommandArgs CommandParser::parseCommand(const std::string& command_line) {
+    CommandScan result = scan(command_line);
+    if (result.needs_shell) {
+        return {"/bin/bash", "-c", command_line};
+    }
+    return std::move(result.args);
+}
+
+CommandScan CommandParser::scan(const std::string& command_line) {
+    CommandScan result;
+    result.needs_shell = classify(command_line, &result.args);
+    if (result.needs_shell) {
+        result.args.clear();
+    }
+    return result;
+}
+
+ShellCommand CommandParser::compile(const std::string& command_line, ShellMode mode) {
+    ShellCommand command;
+    if (!hasWords(command_line)) {
+        return command;     // 空命令：args为空，validateCommand拒绝，不会变成空的bash
+    }
+    if (mode == ShellMode::ALWAYS) {
+        command.args = {"/bin/bash", "-c", command_line};
+        command.interpreted = false;
+        return command;
+    }
+    
+    // 只有普通词的命令（最常见的情况）不需要解释器
+    CommandScan plain = scan(command_line);
+    if (!plain.needs_shell && !plain.args.empty()) {
+        command.args = std::move(plain.args);
+        return command;
     }
     
-    if (!current_token.empty()) {
-        tokens.push_back(current_token);
+    ShellState state;
+    for (char** e = environ; e && *e; ++e) {
+        state.env.push_back(*e);
     }
     
-    return tokens;
+    if (!interpret(command_line, state, &command)) {
+        command = {};
+        if (mode == ShellMode::AUTO) {
+            command.args = {"/bin/bash", "-c", command_line};
+        }
+        command.interpreted = false;
+        return command;
+    }
+    command.cwd = std::move(state.cwd);
+    if (state.env_changed) {
+        command.env = std::move(state.env);
+    }
+    return command;
 }
 
 bool CommandParser::validateCommand(const CommandArgs& args) {
@@ -68,19 +854,7 @@ bool CommandParser::validateCommand(const CommandArgs& args) {
 }
 
 bool CommandParser::needsShell(const std::string& command) {
-    // 检查是否包含shell特殊字符或关键字
-    const std::vector<std::string> shell_operators = {
-        "&&", "||", ";", "|", ">", "<", ">>", "<<",
-        "source", "export", "cd", "$", "`", "$(", ")"
-    };
-    
-    for (const auto& op : shell_operators) {
-        if (command.find(op) != std::string::npos) {
-            return true;
-        }
-    }
-    
-    return false;
+    return classify(command, nullptr);
 }
 
 } // namespace ProcessManager
@@ -0,0 +1,148 @@
+#include "process_manager/descendant_tracker.h"
+#include <dirent.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace ProcessManager {
+
+void DescendantTracker::addRoot(pid_t root, const std::string& module) {
+    add(root, module);
+    roots_.insert(root);
+}
+
+void DescendantTracker::add(pid_t pid, const std::string& module) {
+    auto [it, inserted] = owner_.emplace(pid, module);
+    if (!inserted) {
+        return;
+    }
+    by_module_[module].insert(pid);
+}
+
+size_t DescendantTracker::refresh() {
+    // 广度优先：新发现的进程在同一轮中继续展开
+    std::vector<std::pair<pid_t, std::string>> pending;
+    pending.reserve(owner_.size());
+    for (const auto& [pid, module] : owner_) {
+        pending.emplace_back(pid, module);
+    }
+    
+    size_t added = 0;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        for (pid_t child : readChildren(pending[i].first)) {
+            if (owner_.count(child)) {
+                continue;
+            }
+            add(child, pending[i].second);
+            pending.emplace_back(child, pending[i].second);
+            ++added;
+        }
+    }
+    return added;
+}
+
+size_t DescendantTracker::adoptOrphans(pid_t reaper, pid_t group, const std::string& module) {
+    size_t added = 0;
+    for (pid_t child : readChildren(reaper)) {
+        if (!owner_.count(child) && getpgid(child) == group) {
+            add(child, module);
+            ++added;
+        }
+    }
+    return added;
+}
+
+const std::string* DescendantTracker::moduleOf(pid_t pid) const {
+    auto it = owner_.find(pid);
+    return it != owner_.end() ? &it->second : nullptr;
+}
+
+std::string DescendantTracker::remove(pid_t pid) {
+    auto it = owner_.find(pid);
+    if (it == owner_.end()) {
+        return {};
+    }
+    std::string module = std::move(it->second);
+    owner_.erase(it);
+    roots_.erase(pid);
+    
+    auto mod_it = by_module_.find(module);
+    if (mod_it != by_module_.end()) {
+        mod_it->second.erase(pid);
+        if (mod_it->second.empty()) {
+            by_module_.erase(mod_it);
+        }
+    }
+    return module;
+}
+
+std::vector<pid_t> DescendantTracker::descendantsOf(const std::string& module) const {
+    std::vector<pid_t> result;
+    auto it = by_module_.find(module);
+    if (it == by_module_.end()) {
+        return result;
+    }
+    for (pid_t pid : it->second) {
+        if (!roots_.count(pid)) {
+            result.push_back(pid);
+        }
+    }
+    return result;
+}
+
+size_t DescendantTracker::count(const std::string& module) const {
+    auto it = by_module_.find(module);
+    if (it == by_module_.end()) {
+        return 0;
+    }
+    size_t n = 0;
+    for (pid_t pid : it->second) {
+        n += roots_.count(pid) ? 0 : 1;
+    }
+    return n;
+}
+
+std::vector<pid_t> DescendantTracker::all() const {
+    std::vector<pid_t> result;
+    result.reserve(owner_.size());
+    for (const auto& [pid, module] : owner_) {
+        result.push_back(pid);
+    }
+    return result;
+}
+
+void DescendantTracker::clear() {
+    owner_.clear();
+    by_module_.clear();
+    roots_.clear();
+}
+
+std::vector<pid_t> DescendantTracker::readChildren(pid_t pid) {
+    std::vector<pid_t> children;
+    std::string task_dir = "/proc/" + std::to_string(pid) + "/task";
+    DIR* dir = opendir(task_dir.c_str());
+    if (!dir) {
+        return children;
+    }
+    
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string path = task_dir + "/" + entry->d_name + "/children";
+        FILE* file = fopen(path.c_str(), "re");
+        if (!file) {
+            continue;
+        }
+        long child;
+        while (fscanf(file, "%ld", &child) == 1) {
+            children.push_back(static_cast<pid_t>(child));
+        }
+        fclose(file);
+    }
+    closedir(dir);
+    return children;
+}
+
+} // namespace ProcessManager
@@ -0,0 +1,55 @@
+#include "process_manager/event_bus.h"
+#include <algorithm>
+#include <bit>
+
+namespace ProcessManager {
+
+EventSubscription::EventSubscription(size_t capacity)
+    : slots_(new LifecycleEvent[std::bit_ceil(std::max<size_t>(capacity, 2))]),
+      mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1) {}
+
+bool EventSubscription::push(const LifecycleEvent& event) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    slots_[tail & mask_] = event;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool EventSubscription::poll(LifecycleEvent& event) {
+    return poll(&event, 1) == 1;
+}
+
+size_t EventSubscription::poll(LifecycleEvent* events, size_t max) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t available = tail_.load(std::memory_order_acquire) - head;
+    size_t count = static_cast<size_t>(std::min<uint64_t>(available, max));
+    for (size_t i = 0; i < count; ++i) {
+        events[i] = slots_[(head + i) & mask_];
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+}
+
+std::shared_ptr<EventSubscription> EventBus::subscribe(size_t capacity) {
+    auto subscription = std::make_shared<EventSubscription>(capacity);
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscriptions_.push_back(subscription);
+    return subscription;
+}
+
+void EventBus::publish(const LifecycleEvent* events, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 只剩列表持有的订阅已被订阅者释放
+    std::erase_if(subscriptions_, [](const auto& subscription) { return subscription.use_count() == 1; });
+    for (const auto& subscription : subscriptions_) {
+        for (size_t i = 0; i < count; ++i) {
+            subscription->push(events[i]);
+        }
+    }
+}
+
+} // namespace ProcessManager
@@ -0,0 +1,120 @@
+#include "process_manager/event_loop.h"
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <cerrno>
+#include "ylt/easylog.hpp"
+
+namespace ProcessManager {
+
+namespace {
+constexpr int kMaxEvents = 64;
+constexpr uint64_t kWakeupToken = 0;  // 普通watch的token从1开始
+}
+
+EventLoop::EventLoop() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) {
+        ELOG_ERROR << "epoll_create1 failed, errno " << errno;
+        return;
+    }
+    
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ != -1) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = kWakeupToken;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (wakeup_fd_ != -1) {
+        close(wakeup_fd_);
+    }
+    if (epoll_fd_ != -1) {
+        close(epoll_fd_);
+    }
+}
+
+void EventLoop::wakeup() {
+    if (wakeup_fd_ != -1) {
+        uint64_t one = 1;
+        ssize_t ret = write(wakeup_fd_, &one, sizeof(one));
+        (void)ret;  // 计数器已满（EAGAIN）时本来就处于待唤醒状态
+    }
+}
+
+bool EventLoop::add(int fd, Callback callback, uint32_t events) {
+    if (epoll_fd_ == -1 || fd < 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_to_token_.count(fd)) {
+        return false;
+    }
+
+    // 使用递增token而不是fd作为epoll数据，避免fd被复用后误分发
+    uint64_t token = next_token_++;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = token;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        ELOG_ERROR << "epoll_ctl ADD failed for fd " << fd << ", errno " << errno;
+        return false;
+    }
+
+    watches_.emplace(token, Watch{fd, std::move(callback)});
+    fd_to_token_[fd] = token;
+    return true;
+}
+
+bool EventLoop::remove(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = fd_to_token_.find(fd);
+    if (it == fd_to_token_.end()) {
+        return false;
+    }
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    watches_.erase(it->second);
+    fd_to_token_.erase(it);
+    return true;
+}
+
+int EventLoop::runOnce(int timeout_ms) {
+    if (epoll_fd_ == -1) {
+        return -1;
+    }
+
+    epoll_event events[kMaxEvents];
+    int n = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+    if (n == -1) {
+        // 被信号中断不算错误，交给调用者检查退出标志
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        if (events[i].data.u64 == kWakeupToken) {
+            uint64_t count;
+            ssize_t ret = read(wakeup_fd_, &count, sizeof(count));
+            (void)ret;
+            continue;
+        }
+        
+        Callback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = watches_.find(events[i].data.u64);
+            if (it == watches_.end()) {
+                continue; // 已在本轮之前的回调中被移除
+            }
+            callback = it->second.callback;
+        }
+        // 在锁外调用回调，允许回调中add/remove
+        callback(events[i].events);
+    }
+    return n;
+}
+
+} // namespace ProcessManager
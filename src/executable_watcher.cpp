@@ -0,0 +1,232 @@
+#include "process_manager/executable_watcher.h"
+#include "process_manager/launch_plan.h"
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+namespace ProcessManager {
+
+namespace {
+
+// 文件被创建、删除、rename进出、写入完成或权限变化（chmod +x影响PATH查找）
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB |
+                                IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+std::string currentDir() {
+    char buf[PATH_MAX];
+    return getcwd(buf, sizeof(buf)) ? buf : ".";
+}
+
+// 相对路径按子进程的工作目录解释（exec在chdir之后进行）
+std::string absolute(const std::string& path, const LaunchPlan& plan) {
+    if (!path.empty() && path.front() == '/') {
+        return path;
+    }
+    std::string base = plan.cwd() ? plan.cwd() : currentDir();
+    if (base.front() != '/') {
+        base = currentDir() + "/" + base;
+    }
+    return path.empty() || path == "." ? base : base + "/" + path;
+}
+
+const char* searchPath(const LaunchPlan& plan) {
+    for (char* const* entry = plan.envp(); *entry; ++entry) {
+        if (std::strncmp(*entry, "PATH=", 5) == 0) {
+            return *entry + 5;
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+ExecutableWatcher::~ExecutableWatcher() {
+    close();
+}
+
+bool ExecutableWatcher::open() {
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    return fd_ != -1;
+}
+
+void ExecutableWatcher::close() {
+    if (fd_ != -1) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    dir_wd_.clear();
+    dirs_.clear();
+    modules_.clear();
+}
+
+bool ExecutableWatcher::watch(const std::string& module, const LaunchPlan& plan) {
+    if (fd_ == -1) {
+        return false;
+    }
+
+    // 要监视的(目录, 文件名)：裸命令名为PATH中直到命中目录为止的每个目录
+    std::vector<std::pair<std::string, std::string>> targets;
+    std::string path = plan.path();
+    std::string name = plan.argv()[0];
+    if (name.find('/') == std::string::npos) {
+        std::string search = searchPath(plan);
+        if (search.empty()) {
+            search = "/usr/local/bin:/usr/bin:/bin";
+        }
+        size_t begin = 0;
+        while (begin <= search.size()) {
+            size_t end = search.find(':', begin);
+            if (end == std::string::npos) {
+                end = search.size();
+            }
+            std::string dir = search.substr(begin, end - begin);
+            targets.emplace_back(absolute(dir, plan), name);
+            if ((dir.empty() ? "." : dir) + "/" + name == path) {
+                break;
+            }
+            begin = end + 1;
+        }
+    } else {
+        std::string full = absolute(path, plan);
+        size_t slash = full.rfind('/');
+        targets.emplace_back(slash == 0 ? "/" : full.substr(0, slash), full.substr(slash + 1));
+    }
+
+    // PATH中找不到时path为空，监视上面的各个目录等待它出现
+    FileId id = path.empty() ? FileId{} : identify(absolute(path, plan));
+    bool changed = false;
+    auto previous = modules_.find(module);
+    if (previous != modules_.end()) {
+        changed = previous->second.path != path || !sameFile(previous->second.id, id);
+        unwatch(module);
+    }
+
+    Module& entry = modules_[module];
+    entry.path = path;
+    entry.id = id;
+    for (auto& [dir, file] : targets) {
+        int wd;
+        auto it = dir_wd_.find(dir);
+        if (it != dir_wd_.end()) {
+            wd = it->second;
+        } else {
+            wd = inotify_add_watch(fd_, dir.c_str(), kWatchMask);
+            if (wd == -1) {
+                continue;   // 目录不存在或超出max_user_watches
+            }
+            dir_wd_[dir] = wd;
+        }
+        dirs_[wd][file].insert(module);
+        entry.files.emplace_back(wd, std::move(file));
+    }
+    return changed;
+}
+
+void ExecutableWatcher::unwatch(const std::string& module) {
+    auto it = modules_.find(module);
+    if (it == modules_.end()) {
+        return;
+    }
+    for (const auto& [wd, file] : it->second.files) {
+        auto dir = dirs_.find(wd);
+        if (dir == dirs_.end()) {
+            continue;   // 目录已被删除
+        }
+        auto modules = dir->second.find(file);
+        if (modules != dir->second.end()) {
+            modules->second.erase(module);
+            if (modules->second.empty()) {
+                dir->second.erase(modules);
+            }
+        }
+        if (dir->second.empty()) {
+            inotify_rm_watch(fd_, wd);
+            removeWatch(wd);
+        }
+    }
+    modules_.erase(it);
+}
+
+void ExecutableWatcher::clear() {
+    for (const auto& [wd, files] : dirs_) {
+        inotify_rm_watch(fd_, wd);
+    }
+    dir_wd_.clear();
+    dirs_.clear();
+    modules_.clear();
+}
+
+void ExecutableWatcher::readEvents(const Callback& callback) {
+    std::unordered_set<std::string> changed;
+    alignas(struct inotify_event) char buf[4096];
+    for (;;) {
+        ssize_t n = read(fd_, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        for (char* p = buf; p < buf + n;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (const auto& [module, entry] : modules_) {
+                    changed.insert(module);
+                }
+                continue;
+            }
+            auto dir = dirs_.find(event->wd);
+            if (dir == dirs_.end()) {
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                // 目录本身被删除或移走：其中的模块全部重新解析
+                for (const auto& [file, modules] : dir->second) {
+                    changed.insert(modules.begin(), modules.end());
+                }
+                if (event->mask & IN_IGNORED) {
+                    removeWatch(event->wd);
+                }
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+            auto file = dir->second.find(event->name);
+            if (file != dir->second.end()) {
+                changed.insert(file->second.begin(), file->second.end());
+            }
+        }
+    }
+    for (const auto& module : changed) {
+        callback(module);
+    }
+}
+
+ExecutableWatcher::FileId ExecutableWatcher::identify(const std::string& path) {
+    FileId id;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        id.dev = st.st_dev;
+        id.ino = st.st_ino;
+        id.size = st.st_size;
+        id.mtime = st.st_mtim;
+    }
+    return id;
+}
+
+bool ExecutableWatcher::sameFile(const FileId& a, const FileId& b) {
+    return a.dev == b.dev && a.ino == b.ino && a.size == b.size && a.mtime.tv_sec == b.mtime.tv_sec &&
+           a.mtime.tv_nsec == b.mtime.tv_nsec;
+}
+
+void ExecutableWatcher::removeWatch(int wd) {
+    dirs_.erase(wd);
+    for (auto it = dir_wd_.begin(); it != dir_wd_.end();) {
+        it = it->second == wd ? dir_wd_.erase(it) : std::next(it);
+    }
+}
+
+} // namespace ProcessManager
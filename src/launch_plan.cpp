@@ -0,0 +1,276 @@
+#include "process_manager/launch_plan.h"
+#include "process_manager/process_launcher.h"
+#include "process_manager/command_parser.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+
+namespace ProcessManager {
+
+namespace {
+
+struct WireHeader {
+    uint32_t argc;
+    uint32_t envc;
+    uint32_t has_cwd;
+    uint32_t fd_action_count;
+};
+
+void appendString(std::string& out, const char* s) {
+    out.append(s, std::strlen(s) + 1);
+}
+
+// 从wire中读取一个以NUL结尾的字符串，越界时返回nullptr
+const char* readString(const char*& cursor, const char* end) {
+    const void* nul = std::memchr(cursor, '\0', end - cursor);
+    if (!nul) {
+        return nullptr;
+    }
+    const char* s = cursor;
+    cursor = static_cast<const char*>(nul) + 1;
+    return s;
+}
+
+// 模块的某个标准fd：管理器的fd优先，其次是文件路径，都没有则继承
+void addStdio(std::vector<FdAction>& fd_actions, int target, int fd, const std::string& path, int open_flags) {
+    FdAction action;
+    action.target = target;
+    if (fd != -1) {
+        action.source = fd;
+    } else if (!path.empty()) {
+        action.type = FdAction::OPEN;
+        action.open_flags = open_flags;
+        action.path = path.c_str();     // make()会复制到arena中
+    } else {
+        return;
+    }
+    fd_actions.push_back(action);
+}
+
+} // namespace
+
+std::shared_ptr<const LaunchPlan> LaunchPlan::build(const CommandArgs& args, const std::string& cwd,
+                                                    std::vector<FdAction> fd_actions,
+                                                    const std::vector<std::string>* envp) {
+    if (args.empty()) {
+        return nullptr;
+    }
+    
+    std::vector<const char*> argv;
+    argv.reserve(args.size());
+    for (const auto& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+    std::vector<const char*> env;
+    const char* search_path = nullptr;
+    if (envp) {
+        for (const auto& entry : *envp) {
+            env.push_back(entry.c_str());
+            if (entry.compare(0, 5, "PATH=") == 0) {
+                search_path = entry.c_str() + 5;
+            }
+        }
+    } else {
+        for (char** e = environ; e && *e; ++e) {
+            env.push_back(*e);
+        }
+    }
+    // 按子进程自己的PATH查找
+    std::string path = envp ? ProcessLauncher::resolveExecutable(args[0], search_path ? search_path : "")
+                            : ProcessLauncher::resolveExecutable(args[0]);
+    return make(path.c_str(), argv, env, cwd.empty() ? nullptr : cwd.c_str(), std::move(fd_actions));
+}
+
+std::shared_ptr<const LaunchPlan> LaunchPlan::build(const ShellCommand& command, const ModuleStdio& stdio) {
+    std::vector<FdAction> fd_actions;
+    fd_actions.reserve(command.redirects.size() + stdio.inherit_fds.size() + 4);
+    for (int fd : stdio.inherit_fds) {
+        FdAction action;
+        action.source = fd;
+        action.target = fd;
+        fd_actions.push_back(action);
+    }
+    constexpr int kAppend = O_WRONLY | O_CREAT | O_APPEND;
+    addStdio(fd_actions, STDIN_FILENO, stdio.stdin_fd, stdio.stdin_path, O_RDONLY);
+    addStdio(fd_actions, STDOUT_FILENO, stdio.stdout_fd, stdio.stdout_path, kAppend);
+    if (stdio.stderr_to_stdout) {
+        FdAction action;
+        action.type = FdAction::COPY;
+        action.source = STDOUT_FILENO;
+        action.target = STDERR_FILENO;
+        fd_actions.push_back(action);
+    } else {
+        addStdio(fd_actions, STDERR_FILENO, stdio.stderr_fd, stdio.stderr_path, kAppend);
+    }
+    for (const auto& redirect : command.redirects) {
+        FdAction action;
+        action.target = redirect.target;
+        if (!redirect.path.empty()) {
+            action.type = FdAction::OPEN;
+            action.open_flags = redirect.open_flags;
+            action.path = redirect.path.c_str();    // make()会复制到arena中
+        } else if (redirect.source == -1) {
+            action.type = FdAction::CLOSE;
+        } else {
+            action.type = FdAction::COPY;
+            action.source = redirect.source;
+        }
+        fd_actions.push_back(action);
+    }
+    return build(command.args, command.cwd, std::move(fd_actions), command.env.empty() ? nullptr : &command.env);
+}
+
+LaunchPlan::~LaunchPlan() {
+    if (exec_fd_ != -1) {
+        close(exec_fd_);
+    }
+}
+
+std::shared_ptr<const LaunchPlan> LaunchPlan::withExecFd(int exec_fd) const {
+    std::vector<const char*> args;
+    for (char* const* arg = argv_; *arg; ++arg) {
+        args.push_back(*arg);
+    }
+    std::vector<const char*> env;
+    for (char* const* entry = envp_; *entry; ++entry) {
+        env.push_back(*entry);
+    }
+    auto plan = make(path_, args, env, cwd_, fd_actions_);
+    plan->exec_fd_ = exec_fd;
+    return plan;
+}
+
+std::shared_ptr<LaunchPlan> LaunchPlan::make(const char* path, const std::vector<const char*>& args,
+                                             const std::vector<const char*>& env, const char* cwd,
+                                             std::vector<FdAction> fd_actions) {
+    // 布局：[argv指针 | nullptr | envp指针 | nullptr | path\0 | argv字符串 | envp字符串 | cwd\0 | 重定向路径]
+    size_t pointer_count = args.size() + 1 + env.size() + 1;
+    size_t string_bytes = std::strlen(path) + 1 + (cwd ? std::strlen(cwd) + 1 : 0);
+    for (const auto& action : fd_actions) {
+        if (action.type == FdAction::OPEN) {
+            string_bytes += std::strlen(action.path) + 1;
+        }
+    }
+    for (const char* arg : args) {
+        string_bytes += std::strlen(arg) + 1;
+    }
+    for (const char* entry : env) {
+        string_bytes += std::strlen(entry) + 1;
+    }
+    
+    std::shared_ptr<LaunchPlan> plan(new LaunchPlan());
+    plan->arena_size_ = pointer_count * sizeof(char*) + string_bytes;
+    plan->arena_.reset(new char[plan->arena_size_]);
+    
+    char** pointers = reinterpret_cast<char**>(plan->arena_.get());
+    char* cursor = plan->arena_.get() + pointer_count * sizeof(char*);
+    auto append = [&cursor](const char* s) {
+        size_t len = std::strlen(s);
+        char* start = cursor;
+        std::memcpy(cursor, s, len + 1);
+        cursor += len + 1;
+        return start;
+    };
+    
+    plan->path_ = append(path);
+    plan->argv_ = pointers;
+    for (const char* arg : args) {
+        *pointers++ = append(arg);
+    }
+    *pointers++ = nullptr;
+    plan->envp_ = pointers;
+    for (const char* entry : env) {
+        *pointers++ = append(entry);
+    }
+    *pointers++ = nullptr;
+    if (cwd) {
+        plan->cwd_ = append(cwd);
+    }
+    plan->fd_actions_ = std::move(fd_actions);
+    for (auto& action : plan->fd_actions_) {
+        if (action.type == FdAction::OPEN) {
+            action.path = append(action.path);
+        }
+    }
+    
+    // 预先序列化，发送给zygote时无需再次编码
+    WireHeader header{static_cast<uint32_t>(args.size()), static_cast<uint32_t>(env.size()),
+                      cwd ? 1u : 0u, static_cast<uint32_t>(plan->fd_actions_.size())};
+    plan->wire_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    plan->wire_.append(reinterpret_cast<const char*>(plan->fd_actions_.data()),
+                       plan->fd_actions_.size() * sizeof(FdAction));
+    appendString(plan->wire_, plan->path_);
+    for (char* const* arg = plan->argv_; *arg; ++arg) {
+        appendString(plan->wire_, *arg);
+    }
+    for (char* const* entry = plan->envp_; *entry; ++entry) {
+        appendString(plan->wire_, *entry);
+    }
+    if (plan->cwd_) {
+        appendString(plan->wire_, plan->cwd_);
+    }
+    for (const auto& action : plan->fd_actions_) {
+        if (action.type == FdAction::OPEN) {
+            appendString(plan->wire_, action.path);
+        }
+    }
+    return plan;
+}
+
+std::shared_ptr<const LaunchPlan> LaunchPlan::fromWire(const char* data, size_t size, const int* fds, size_t fd_count) {
+    WireHeader header;
+    if (size < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    const char* cursor = data + sizeof(header);
+    const char* end = data + size;
+    
+    size_t action_bytes = static_cast<size_t>(header.fd_action_count) * sizeof(FdAction);
+    if (static_cast<size_t>(end - cursor) < action_bytes) {
+        return nullptr;
+    }
+    std::vector<FdAction> fd_actions(header.fd_action_count);
+    std::memcpy(fd_actions.data(), cursor, action_bytes);
+    cursor += action_bytes;
+    // 源fd随消息通过SCM_RIGHTS传来，按顺序替换为本进程中的编号
+    size_t next_fd = 0;
+    for (auto& action : fd_actions) {
+        if (action.type == FdAction::DUP2) {
+            if (next_fd >= fd_count) {
+                return nullptr;
+            }
+            action.source = fds[next_fd++];
+        }
+        action.path = nullptr;
+    }
+    
+    const char* path = readString(cursor, end);
+    std::vector<const char*> args(header.argc);
+    std::vector<const char*> env(header.envc);
+    for (auto& arg : args) {
+        arg = readString(cursor, end);
+        if (!arg) {
+            return nullptr;
+        }
+    }
+    for (auto& entry : env) {
+        entry = readString(cursor, end);
+        if (!entry) {
+            return nullptr;
+        }
+    }
+    const char* cwd = header.has_cwd ? readString(cursor, end) : nullptr;
+    if (!path || args.empty() || (header.has_cwd && !cwd)) {
+        return nullptr;
+    }
+    for (auto& action : fd_actions) {
+        if (action.type == FdAction::OPEN && !(action.path = readString(cursor, end))) {
+            return nullptr;
+        }
+    }
+    return make(path, args, env, cwd, std::move(fd_actions));
+}
+
+} // namespace ProcessManager
@@ -3,11 +3,108 @@
 #include <thread>
 #include <chrono>
 #include "process_manager/config.h"
+#include "process_manager/signal_handler.h"
 #include <numeric>
+#include <cstring>
+#include <cerrno>
+
+namespace {
+
+void reportStatus(const ProcessManager::ProcessManager& pm) {
+    auto processes = pm.getAllProcesses();
+    for (const auto& proc : processes) {
+        const char* state_str = "UNKNOWN";
+        switch (proc.state) {
+            case ProcessManager::ProcessState::STOPPED: state_str = "STOPPED"; break;
+            case ProcessManager::ProcessState::STARTING: state_str = "STARTING"; break;
+            case ProcessManager::ProcessState::RUNNING: state_str = "RUNNING"; break;
+            case ProcessManager::ProcessState::STOPPING: state_str = "STOPPING"; break;
+            case ProcessManager::ProcessState::CRASHED: state_str = "CRASHED"; break;
+            case ProcessManager::ProcessState::FAILED: state_str = "FAILED"; break;
+        }
+        ELOG_INFO << "Module [" << proc.name << "] - State: " << state_str 
+                  << ", PID: " << proc.pid << ", Restarts: " << proc.restart_count
+                  << ", Descendants: " << proc.descendants
+                  << (proc.binary_replaced ? ", binary replaced on disk" : "");
+    }
+    easylog::flush();
+}
+
+ProcessManager::ModuleStdio stdioOf(const ProcessManager::ModuleConfig& module) {
+    ProcessManager::ModuleStdio stdio;
+    stdio.stdin_path = module.stdin_path.value_or("");
+    stdio.stdout_path = module.stdout_path.value_or("");
+    stdio.stderr_path = module.stderr_path.value_or("");
+    // 写同一个文件时共享同一个打开的文件（2>&1）
+    if (!stdio.stderr_path.empty() && stdio.stderr_path == stdio.stdout_path) {
+        stdio.stderr_to_stdout = true;
+    }
+    return stdio;
+}
+
+// 按配置添加模块：argv形式直接进入启动计划，command按shell字段决定执行方式
+bool addConfigured(ProcessManager::ProcessManager& pm, const std::string& name,
+                   const ProcessManager::ModuleConfig& module) {
+    if (module.argv) {
+        if (!module.command.empty() || module.shell.value_or(false)) {
+            ELOG_ERROR << "Module [" << name << "]: argv cannot be combined with command or shell: true";
+            return false;
+        }
+        return pm.addModuleArgv(name, *module.argv, module.restart_on_failure, stdioOf(module));
+    }
+    auto shell = !module.shell ? ProcessManager::ShellMode::AUTO
+                 : *module.shell ? ProcessManager::ShellMode::ALWAYS
+                                 : ProcessManager::ShellMode::NEVER;
+    return pm.addModule(name, module.command, module.restart_on_failure, stdioOf(module), shell);
+}
+
+// SIGHUP：重新加载配置，启动新增模块，移除已删除或命令变化的模块
+void reloadConfig(ProcessManager::ProcessManager& pm,
+                  std::map<std::string, ProcessManager::ModuleConfig>& current) {
+    ELOG_INFO << "Reloading configuration...";
+    auto config = ProcessManager::load_config("modules.yaml");
+    if (config.modules.empty()) {
+        pm.notifyConfigReloaded(EINVAL);
+        return;
+    }
+    
+    std::vector<std::string> unchanged;
+    for (const auto& [name, module] : current) {
+        auto it = config.modules.find(name);
+        if (it == config.modules.end() || it->second.command != module.command || it->second.argv != module.argv ||
+            it->second.shell != module.shell || it->second.restart_on_failure != module.restart_on_failure || it->second.stdin_path != module.stdin_path ||
+            it->second.stdout_path != module.stdout_path || it->second.stderr_path != module.stderr_path) {
+            ELOG_INFO << "Removing module [" << name << "]";
+            pm.removeModule(name);
+        } else {
+            unchanged.push_back(name);
+        }
+    }
+    
+    for (const auto& [name, module] : config.modules) {
+        if (std::find(unchanged.begin(), unchanged.end(), name) != unchanged.end()) {
+            continue;
+        }
+        if (addConfigured(pm, name, module)) {
+            pm.startModule(name);
+        }
+    }
+    current = std::move(config.modules);
+    pm.notifyConfigReloaded();
+}
+
+} // namespace
 
 int main() {
+    // 必须在创建任何线程（包括easylog的异步线程）之前阻塞信号
+    ProcessManager::SignalHandler::blockSignals();
+    
     easylog::init_log(easylog::Severity::DEBUG, "testlog.txt", true, true);
-    ProcessManager::ProcessManager pm;
+    ProcessManager::SupervisorOptions options;
+    options.mode = ProcessManager::SupervisorMode::EVENT;
+    options.child_subreaper = true;
+    options.watch_executables = true;
+    ProcessManager::ProcessManager pm(options);
     
     auto config = ProcessManager::load_config("modules.yaml");
     if (config.modules.empty()) {
@@ -21,48 +118,30 @@ int main() {
     }
     // 添加模块
     for (const auto& [name, module] : config.modules) {
-        // 拼接命令行参数
-        pm.addModule(name, module.command, module.restart_on_failure);
+        addConfigured(pm, name, module);
     }
 
     // 启动模块
     ELOG_INFO << "Starting modules...";
-    for (const auto& [name, module] : config.modules) {
-        pm.startModule(name);
+    for (const auto& result : pm.startAll()) {
+        if (!result.started) {
+            ELOG_ERROR << "Module [" << result.name << "] failed to start: " << std::strerror(result.error);
+        }
     }
     
+    auto modules = std::move(config.modules);
+    pm.setSignalCallback(SIGHUP, [&] { reloadConfig(pm, modules); });
+    pm.setSignalCallback(SIGUSR1, [&] { reportStatus(pm); });
+    
     // 主循环
     ELOG_INFO << "Process manager started. Press Ctrl+C to exit.";
     
-    int loop_count = 0;
+    // 每10秒显示一次状态
+    pm.schedulePeriodic(std::chrono::seconds(10), [&] { reportStatus(pm); });
     
     while (!pm.shouldExit()) {
-        // 检查子进程状态
-        pm.checkChildProcesses();
-        
-        // 处理重启队列
-        pm.processRestartQueue();
-        
-        // 每10次循环显示一次状态（约10秒）
-        if (++loop_count % 10 == 0) {
-            auto processes = pm.getAllProcesses();
-            for (const auto& proc : processes) {
-                const char* state_str = "UNKNOWN";
-                switch (proc.state) {
-                    case ProcessManager::ProcessState::STOPPED: state_str = "STOPPED"; break;
-                    case ProcessManager::ProcessState::STARTING: state_str = "STARTING"; break;
-                    case ProcessManager::ProcessState::RUNNING: state_str = "RUNNING"; break;
-                    case ProcessManager::ProcessState::STOPPING: state_str = "STOPPING"; break;
-                    case ProcessManager::ProcessState::CRASHED: state_str = "CRASHED"; break;
-                }
-                ELOG_INFO << "Module [" << proc.name << "] - State: " << state_str 
-                          << ", PID: " << proc.pid << ", Restarts: " << proc.restart_count;
-            }
-            easylog::flush();
-        }
-        
-        // 短暂休眠，避免过度消耗CPU
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        // 等待子进程退出、信号和定时器事件
+        pm.runOnce(-1);
     }
     
     ELOG_INFO << "Shutdown signal received. Stopping all processes...";
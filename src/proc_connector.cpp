@@ -0,0 +1,138 @@
+#include "process_manager/proc_connector.h"
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include <cerrno>
+#include <cstring>
+#include "ylt/easylog.hpp"
+
+namespace ProcessManager {
+
+ProcConnector::~ProcConnector() {
+    close();
+}
+
+bool ProcConnector::open() {
+    if (fd_ != -1) {
+        return true;
+    }
+    
+    fd_ = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd_ == -1) {
+        ELOG_WARN << "Failed to create proc connector socket, errno " << errno;
+        return false;
+    }
+    
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = 0;  // 由内核分配端口
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || !sendControl(true)) {
+        ELOG_WARN << "Failed to subscribe to proc connector, errno " << errno
+                  << (errno == EPERM ? " (CAP_NET_ADMIN required)" : "");
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void ProcConnector::close() {
+    if (fd_ == -1) {
+        return;
+    }
+    sendControl(false);
+    ::close(fd_);
+    fd_ = -1;
+}
+
+bool ProcConnector::sendControl(bool listen) {
+    // nlmsghdr | cn_msg | proc_cn_mcast_op（cn_msg以柔性数组结尾，不能直接嵌入结构体）
+    constexpr size_t kLen = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    alignas(nlmsghdr) char buf[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] = {};
+    
+    auto* nlh = reinterpret_cast<nlmsghdr*>(buf);
+    nlh->nlmsg_len = kLen;
+    nlh->nlmsg_type = NLMSG_DONE;
+    nlh->nlmsg_pid = static_cast<__u32>(getpid());
+    
+    auto* cn = static_cast<cn_msg*>(NLMSG_DATA(nlh));
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(proc_cn_mcast_op);
+    
+    proc_cn_mcast_op op = listen ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+    std::memcpy(cn->data, &op, sizeof(op));
+    
+    return send(fd_, buf, kLen, 0) == static_cast<ssize_t>(kLen);
+}
+
+bool ProcConnector::readEvents(const Callback& callback) {
+    alignas(nlmsghdr) char buf[8192];
+    bool complete = true;
+    
+    while (true) {
+        ssize_t len = recv(fd_, buf, sizeof(buf), 0);
+        if (len == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                complete = false;  // 内核丢弃了事件，继续读取剩余部分
+                continue;
+            }
+            break;  // EAGAIN：已读完
+        }
+        if (len == 0) {
+            break;
+        }
+        
+        int remaining = static_cast<int>(len);
+        for (auto* nlh = reinterpret_cast<nlmsghdr*>(buf); NLMSG_OK(nlh, remaining);
+             nlh = NLMSG_NEXT(nlh, remaining)) {
+            if (nlh->nlmsg_type == NLMSG_ERROR || nlh->nlmsg_type == NLMSG_NOOP) {
+                continue;
+            }
+            auto* cn = static_cast<cn_msg*>(NLMSG_DATA(nlh));
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) {
+                continue;
+            }
+            auto* ev = reinterpret_cast<proc_event*>(cn->data);
+            
+            ProcEvent event{};
+            switch (ev->what) {
+                case proc_event::PROC_EVENT_FORK:
+                    if (ev->event_data.fork.child_pid != ev->event_data.fork.child_tgid) {
+                        continue;  // 新线程
+                    }
+                    event.type = ProcEvent::Type::FORK;
+                    event.pid = ev->event_data.fork.child_tgid;
+                    event.parent = ev->event_data.fork.parent_tgid;
+                    break;
+                case proc_event::PROC_EVENT_EXEC:
+                    event.type = ProcEvent::Type::EXEC;
+                    event.pid = ev->event_data.exec.process_tgid;
+                    event.parent = 0;
+                    break;
+                case proc_event::PROC_EVENT_EXIT:
+                    if (ev->event_data.exit.process_pid != ev->event_data.exit.process_tgid) {
+                        continue;  // 线程退出
+                    }
+                    event.type = ProcEvent::Type::EXIT;
+                    event.pid = ev->event_data.exit.process_tgid;
+                    event.parent = ev->event_data.exit.parent_tgid;
+                    event.exit_code = static_cast<int>(ev->event_data.exit.exit_code);
+                    break;
+                default:
+                    continue;
+            }
+            callback(event);
+        }
+    }
+    
+    return complete;
+}
+
+} // namespace ProcessManager
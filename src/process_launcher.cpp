@@ -1,35 +1,433 @@
 #include "process_manager/process_launcher.h"
+#include "process_manager/launch_plan.h"
 #include <sys/wait.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sched.h>
 #include <signal.h>
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
-#include "ylt/easylog.hpp"
 
 namespace ProcessManager {
 
-std::optional<pid_t> ProcessLauncher::launch(const CommandArgs& args) {
-    if (args.empty()) {
-        return std::nullopt;
+namespace {
+
+#ifndef CLONE_PIDFD
+#define CLONE_PIDFD 0x00001000
+#endif
+constexpr uint64_t kCloneIntoCgroup = 0x200000000ULL;  // CLONE_INTO_CGROUP（Linux 5.7）
+constexpr unsigned kCloseRangeCloexec = 1U << 2;        // CLOSE_RANGE_CLOEXEC（Linux 5.11）
+
+// struct clone_args（linux/sched.h与glibc的sched.h不能同时包含）
+struct CloneArgs {
+    uint64_t flags;
+    uint64_t pidfd;
+    uint64_t child_tid;
+    uint64_t parent_tid;
+    uint64_t exit_signal;
+    uint64_t stack;
+    uint64_t stack_size;
+    uint64_t tls;
+    uint64_t set_tid;
+    uint64_t set_tid_size;
+    uint64_t cgroup;
+};
+
+// VFORK后端子进程的栈：父进程在子进程exec之前被挂起，栈只需容纳execve的调用
+constexpr size_t kVforkStackSize = 64 * 1024;
+// 脚本回退时栈上参数数组的容量（占用kVforkStackSize的八分之一）
+constexpr size_t kMaxScriptArgs = 1024;
+
+struct ExecContext {
+    const char* path;
+    char* const* argv;
+    char* const* envp;
+    const char* cwd;
+    const FdAction* fd_actions;
+    size_t fd_action_count;
+    int exec_fd;            // 预热时打开的O_PATH fd，-1表示按路径execve
+    // exec失败时的errno回报：独立地址空间的后端写入CLOEXEC管道，
+    // exec成功时管道随之关闭；共享地址空间（VFORK）直接写入父进程的变量
+    int error_fd;
+    int* exec_errno;
+    bool new_process_group = false;
+};
+
+[[noreturn]] void failChild(const ExecContext& ctx) {
+    int err = errno;
+    if (ctx.error_fd != -1) {
+        ssize_t ret;
+        do {
+            ret = write(ctx.error_fd, &err, sizeof(err));
+        } while (ret == -1 && errno == EINTR);
+    } else if (ctx.exec_errno) {
+        *ctx.exec_errno = err;
+    }
+    _exit(127);
+}
+
+// 给first及以上的所有fd设置CLOEXEC：close_range是一次系统调用，与打开的fd数量无关；
+// 内核不支持时（5.11之前）逐个设置到RLIMIT_NOFILE
+void markCloexecFrom(int first) {
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, first, ~0U, kCloseRangeCloexec) == 0) {
+        return;
+    }
+#endif
+    struct rlimit limit;
+    rlim_t max_fd = getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY ? limit.rlim_cur : 1024;
+    for (rlim_t fd = first; fd < max_fd; ++fd) {
+        fcntl(static_cast<int>(fd), F_SETFD, FD_CLOEXEC);
+    }
+}
+
+// exec_fd是否仍是path当前指向的文件；相对路径基于chdir之后的工作目录，与execve一致
+bool sameFile(int exec_fd, const char* path) {
+    struct stat by_fd;
+    struct stat by_path;
+    return fstat(exec_fd, &by_fd) == 0 && stat(path, &by_path) == 0 &&
+           by_fd.st_dev == by_path.st_dev && by_fd.st_ino == by_path.st_ino;
+}
+
+// 没有#!行的可执行脚本：与execvp相同，改由/bin/sh解释执行。
+// 参数数组放在栈上，参数过多时放弃回退，保留ENOEXEC
+void execScript(const ExecContext& ctx) {
+    const char* argv[kMaxScriptArgs];
+    size_t argc = 0;
+    argv[argc++] = "/bin/sh";
+    argv[argc++] = ctx.path;
+    for (char* const* arg = ctx.argv + 1; *arg; ++arg) {
+        if (argc + 1 >= kMaxScriptArgs) {
+            errno = ENOEXEC;
+            return;
+        }
+        argv[argc++] = *arg;
+    }
+    argv[argc] = nullptr;
+    execve("/bin/sh", const_cast<char* const*>(argv), ctx.envp);
+    errno = ENOEXEC;
+}
+
+// 在子进程中执行：只使用异步信号安全的调用，不分配内存
+[[noreturn]] void execChild(const ExecContext& ctx) {
+    // 恢复信号掩码，signalfd模式下父进程阻塞的信号不能遗传给模块
+    sigset_t empty_set;
+    sigemptyset(&empty_set);
+    sigprocmask(SIG_SETMASK, &empty_set, nullptr);
+    if (ctx.new_process_group && setpgid(0, 0) == -1) {
+        failChild(ctx);
+    }
+    
+    // 先chdir：与shell的 cd X && cmd > file 一致，相对路径的重定向基于新的工作目录
+    if (ctx.cwd && chdir(ctx.cwd) == -1) {
+        failChild(ctx);
+    }
+    for (size_t i = 0; i < ctx.fd_action_count; ++i) {
+        const FdAction& action = ctx.fd_actions[i];
+        switch (action.type) {
+            case FdAction::CLOSE:
+                close(action.target);
+                break;
+            case FdAction::OPEN: {
+                int fd = open(action.path, action.open_flags, 0666);
+                if (fd == -1) {
+                    failChild(ctx);
+                }
+                if (fd != action.target) {
+                    if (dup2(fd, action.target) == -1) {
+                        failChild(ctx);
+                    }
+                    close(fd);
+                }
+                break;
+            }
+            case FdAction::DUP2:
+            case FdAction::COPY:
+                if (action.source != action.target && dup2(action.source, action.target) == -1) {
+                    failChild(ctx);
+                }
+                break;
+        }
+    }
+    
+    // 0/1/2以外的fd一律在exec时关闭：管理器的日志文件、epoll、pidfd、socket等不泄漏给模块。
+    // 只标记CLOEXEC而不立即关闭，exec_fd和错误管道在exec之前仍然可用
+    markCloexecFrom(3);
+    for (size_t i = 0; i < ctx.fd_action_count; ++i) {
+        const FdAction& action = ctx.fd_actions[i];
+        // fd操作的目标（包括继承列表）保留给模块
+        if (action.type != FdAction::CLOSE && action.target > 2) {
+            fcntl(action.target, F_SETFD, 0);
+        }
     }
     
+#ifdef SYS_execveat
+    if (ctx.exec_fd != -1) {
+        // 重定向覆盖了该fd编号时它已不是可执行文件，改为按路径启动
+        bool clobbered = false;
+        for (size_t i = 0; i < ctx.fd_action_count; ++i) {
+            clobbered |= ctx.fd_actions[i].target == ctx.exec_fd;
+        }
+        // 路径已指向别的文件（重新部署后预热时打开的是旧inode），同样按路径启动
+        if (!clobbered && sameFile(ctx.exec_fd, ctx.path)) {
+            syscall(SYS_execveat, ctx.exec_fd, "", ctx.argv, ctx.envp, AT_EMPTY_PATH);
+            if (errno == ENOEXEC) {
+                execScript(ctx);
+            }
+            if (errno != ENOSYS) {
+                failChild(ctx);
+            }
+        }
+    }
+#endif
+    execve(ctx.path, ctx.argv, ctx.envp);
+    if (errno == ENOEXEC) {
+        execScript(ctx);
+    }
+    failChild(ctx);
+}
+
+int vforkEntry(void* arg) {
+    execChild(*static_cast<const ExecContext*>(arg));
+}
+
+pid_t launchFork(const ExecContext& ctx) {
     pid_t pid = fork();
     if (pid == 0) {
-        // 子进程
-        std::vector<char*> argv;
-        for (const auto& arg : args) {
-            argv.push_back(const_cast<char*>(arg.c_str()));
-        }
-        argv.push_back(nullptr);
-        
-        execvp(argv[0], argv.data());
-        ELOG_ERROR << "Failed to exec " << argv[0];
-        _exit(1);
-    } else if (pid > 0) {
-        // 父进程
-        return pid;
+        execChild(ctx);
+    }
+    return pid;
+}
+
+pid_t launchVfork(const ExecContext& ctx, bool clone_parent, int* pidfd) {
+    alignas(16) char stack[kVforkStackSize];
+    int flags = CLONE_VM | CLONE_VFORK | SIGCHLD | (clone_parent ? CLONE_PARENT : 0);
+    
+    // CLONE_PIDFD时pidfd写入parent_tid参数的位置
+    int fd = -1;
+    pid_t pid = clone(vforkEntry, stack + sizeof(stack), flags | CLONE_PIDFD,
+                      const_cast<ExecContext*>(&ctx), &fd);
+    if (pid == -1 && errno == EINVAL) {
+        // 内核不支持CLONE_PIDFD（5.2之前）
+        fd = -1;
+        pid = clone(vforkEntry, stack + sizeof(stack), flags, const_cast<ExecContext*>(&ctx));
+    }
+    if (pid > 0 && pidfd) {
+        *pidfd = fd;
+    } else if (fd != -1) {
+        close(fd);
+    }
+    return pid;
+}
+
+pid_t launchPosixSpawn(const ExecContext& ctx) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+    constexpr bool kCanCloseFrom = true;
+#else
+    constexpr bool kCanCloseFrom = false;
+#endif
+    if (ctx.cwd || ctx.fd_action_count > 0 || !kCanCloseFrom) {
+        // posix_spawn_file_actions会分配内存且chdir需要glibc 2.29，交给vfork后端；
+        // 没有addclosefrom_np（glibc 2.34）时无法关闭继承的fd，同样交给vfork后端
+        return launchVfork(ctx, false, nullptr);
+    }
+    
+    // 与其他后端一样，子进程只继承0/1/2
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+    posix_spawn_file_actions_addclosefrom_np(&file_actions, 3);
+#endif
+    
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t empty_set;
+    sigemptyset(&empty_set);
+    posix_spawnattr_setsigmask(&attr, &empty_set);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | (ctx.new_process_group ? POSIX_SPAWN_SETPGROUP : 0));
+    
+    pid_t pid = -1;
+    int err = posix_spawn(&pid, ctx.path, &file_actions, &attr, ctx.argv, ctx.envp);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&file_actions);
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+pid_t launchClone3(const ExecContext& ctx, const LaunchOptions& options, int* pidfd) {
+#ifdef SYS_clone3
+    int fd = -1;
+    CloneArgs args{};
+    args.flags = CLONE_PIDFD;
+    args.pidfd = reinterpret_cast<uint64_t>(&fd);
+    if (options.clone_parent) {
+        args.flags |= CLONE_PARENT;     // 退出信号沿用调用者自己的exit_signal
     } else {
-        // fork失败
+        args.exit_signal = SIGCHLD;
+    }
+    if (options.cgroup_fd >= 0) {
+        args.flags |= kCloneIntoCgroup;
+        args.cgroup = static_cast<uint64_t>(options.cgroup_fd);
+    }
+    
+    // 不带CLONE_VM：子进程在独立的地址空间中从这里返回
+    long ret = syscall(SYS_clone3, &args, sizeof(args));
+    if (ret == 0) {
+        execChild(ctx);
+    }
+    if (ret > 0) {
+        if (pidfd) {
+            *pidfd = fd;
+        } else {
+            close(fd);
+        }
+        return static_cast<pid_t>(ret);
+    }
+    if (errno != ENOSYS || options.clone_parent) {
+        return -1;
+    }
+    // 内核不支持clone3（5.3之前），退回fork
+#else
+    (void)pidfd;
+    if (options.clone_parent) {
+        errno = ENOSYS;
+        return -1;
+    }
+#endif
+    return launchFork(ctx);
+}
+
+} // namespace
+
+std::optional<pid_t> ProcessLauncher::launch(const CommandArgs& args, const LaunchOptions& options, int* pidfd) {
+    auto plan = LaunchPlan::build(args);
+    if (!plan) {
+        if (pidfd) {
+            *pidfd = -1;
+        }
+        return std::nullopt;
+    }
+    return launch(*plan, options, pidfd);
+}
+
+std::optional<pid_t> ProcessLauncher::launch(const LaunchPlan& plan, const LaunchOptions& options, int* pidfd) {
+    if (pidfd) {
+        *pidfd = -1;
+    }
+    
+    // 所有准备工作都已在构建计划时完成，这里不分配内存
+    int exec_errno = 0;
+    int error_pipe[2] = {-1, -1};
+    bool own_address_space = options.backend == LaunchBackend::FORK || options.backend == LaunchBackend::CLONE3;
+    if (own_address_space && pipe2(error_pipe, O_CLOEXEC) == -1) {
+        return std::nullopt;
+    }
+    ExecContext ctx{plan.path(), plan.argv(), plan.envp(), plan.cwd(),
+                    plan.fdActions().data(), plan.fdActions().size(), plan.execFd(), error_pipe[1], &exec_errno,
+                    options.new_process_group};
+    
+    pid_t pid = -1;
+    switch (options.backend) {
+        case LaunchBackend::FORK:
+            pid = launchFork(ctx);
+            break;
+        case LaunchBackend::POSIX_SPAWN:
+            pid = launchPosixSpawn(ctx);
+            break;
+        case LaunchBackend::VFORK:
+            pid = launchVfork(ctx, options.clone_parent, pidfd);
+            break;
+        case LaunchBackend::CLONE3:
+            pid = launchClone3(ctx, options, pidfd);
+            break;
+    }
+    
+    int launch_errno = errno;
+    
+    if (error_pipe[1] != -1) {
+        close(error_pipe[1]);
+        if (pid > 0) {
+            // 阻塞到子进程exec（管道被CLOEXEC关闭，读到EOF）或回报错误
+            ssize_t n;
+            do {
+                n = read(error_pipe[0], &exec_errno, sizeof(exec_errno));
+            } while (n == -1 && errno == EINTR);
+            if (n != static_cast<ssize_t>(sizeof(exec_errno))) {
+                exec_errno = 0;
+            }
+        }
+        close(error_pipe[0]);
+    }
+    
+    if (pid > 0 && exec_errno != 0) {
+        if (!options.clone_parent) {
+            // 子进程已经_exit，由这里回收，不交给调用者
+            waitpid(pid, nullptr, 0);
+            if (pidfd && *pidfd != -1) {
+                close(*pidfd);
+                *pidfd = -1;
+            }
+        }
+        pid = -1;
+        launch_errno = exec_errno;
+    }
+    
+    if (pid <= 0) {
+        errno = launch_errno;
         return std::nullopt;
     }
+    return pid;
+}
+
+bool ProcessLauncher::isPermanentError(int err) {
+    switch (err) {
+        case ENOENT:
+        case EACCES:
+        case ENOEXEC:
+        case ENOTDIR:
+        case ELOOP:
+        case ENAMETOOLONG:
+        case EISDIR:
+        case ELIBBAD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string ProcessLauncher::resolveExecutable(const std::string& file, const char* search_path) {
+    if (file.empty() || file.find('/') != std::string::npos) {
+        return file;
+    }
+    
+    const char* env_path = search_path ? search_path : getenv("PATH");
+    std::string search = env_path && *env_path ? env_path : "/usr/local/bin:/usr/bin:/bin";
+    size_t begin = 0;
+    while (begin <= search.size()) {
+        size_t end = search.find(':', begin);
+        if (end == std::string::npos) {
+            end = search.size();
+        }
+        std::string dir = search.substr(begin, end - begin);
+        std::string candidate = (dir.empty() ? "." : dir) + "/" + file;
+        // 与execvp一致，跳过目录等非普通文件
+        struct stat st;
+        if (stat(candidate.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+        begin = end + 1;
+    }
+    // 不能原样返回：execve会把裸命令名当作工作目录下的相对路径
+    return {};
 }
 
 bool ProcessLauncher::terminate(pid_t pid, int signal) {
@@ -40,4 +438,49 @@ bool ProcessLauncher::isProcessAlive(pid_t pid) {
     return kill(pid, 0) == 0;
 }
 
+int ProcessLauncher::openPidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+pid_t ProcessLauncher::reap(pid_t pid, int pidfd, int* status, struct rusage* usage) {
+#if defined(SYS_waitid) && defined(SYS_pidfd_open)
+    if (pidfd != -1) {
+        constexpr int kPidfdIdType = 3;  // P_PIDFD，旧版glibc未定义
+        siginfo_t info;
+        std::memset(&info, 0, sizeof(info));
+        // glibc的waitid不暴露rusage参数，直接使用系统调用
+        if (syscall(SYS_waitid, kPidfdIdType, pidfd, &info, WEXITED | WNOHANG, usage) == 0) {
+            if (info.si_pid == 0) {
+                return 0;
+            }
+            switch (info.si_code) {
+                case CLD_EXITED:
+                    *status = (info.si_status & 0xff) << 8;
+                    break;
+                case CLD_DUMPED:
+                    *status = info.si_status | 0x80;
+                    break;
+                default:  // CLD_KILLED
+                    *status = info.si_status;
+                    break;
+            }
+            return info.si_pid;
+        }
+        if (errno != EINVAL) {
+            return -1;
+        }
+        // 内核不支持P_PIDFD（5.4之前），退回wait4
+    }
+#else
+    (void)pidfd;
+#endif
+    return wait4(pid, status, WNOHANG, usage);
+}
+
 } // namespace ProcessManager
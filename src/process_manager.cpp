@@ -7,153 +7,715 @@
 #include <thread>
 #include <chrono>
 #include <sys/wait.h>
+#include <sys/prctl.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
 #include "ylt/easylog.hpp"
 
 
 namespace ProcessManager {
 
-ProcessManager::ProcessManager() {
+namespace {
+// 轮询模式（或pidfd不可用时）两次waitpid扫描之间的最长间隔
+constexpr int kPollIntervalMs = 1000;
+}
+
+ProcessManager::ProcessManager(SupervisorOptions options) : options_(options) {
+    mutex_.enableStats(options_.lock_stats);
+    if (options_.mode == SupervisorMode::EVENT && !loop_.isValid()) {
+        ELOG_WARN << "epoll unavailable, falling back to polling";
+        pidfd_supported_ = false;
+    }
+    
+    launch_options_.backend = options_.launch_backend;
+    // 收割者模式下每个主进程自成进程组，主进程退出后按进程组认领过继给管理器的孤儿
+    launch_options_.new_process_group = options_.child_subreaper;
+    if (!options_.cgroup_path.empty()) {
+        if (options_.launch_backend != LaunchBackend::CLONE3 && !options_.use_zygote) {
+            ELOG_WARN << "cgroup_path requires the CLONE3 launch backend or zygote, ignored";
+        } else {
+            launch_options_.cgroup_fd = open(options_.cgroup_path.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+            if (launch_options_.cgroup_fd == -1) {
+                ELOG_WARN << "Failed to open cgroup " << options_.cgroup_path << ", errno " << errno;
+            }
+        }
+    }
+    
+    // 尽早fork，zygote的地址空间越小，之后每次clone越快
+    if (options_.use_zygote && !zygote_.start(launch_options_.cgroup_fd, launch_options_.new_process_group)) {
+        ELOG_WARN << "Failed to start zygote (errno " << errno << "), launching directly";
+    }
+    
+    if (options_.proc_events) {
+        if (options_.mode != SupervisorMode::EVENT || !loop_.isValid()) {
+            ELOG_WARN << "Proc connector requires EVENT mode, ignored";
+        } else if (!proc_events_.open() ||
+                   !loop_.add(proc_events_.fd(), [this](uint32_t) { onProcEventsReadable(); })) {
+            proc_events_.close();
+            ELOG_WARN << "Proc connector unavailable, falling back to pidfd-only monitoring";
+        }
+    }
+    
+    if (options_.watch_executables) {
+        if (options_.mode != SupervisorMode::EVENT || !loop_.isValid()) {
+            ELOG_WARN << "Executable watching requires EVENT mode, ignored";
+        } else if (!executables_.open() ||
+                   !loop_.add(executables_.fd(), [this](uint32_t) { onExecutablesReadable(); })) {
+            executables_.close();
+            ELOG_WARN << "inotify unavailable (errno " << errno << "), executables will not be watched";
+        }
+    }
+    
+    if (options_.child_subreaper) {
+        if (prctl(PR_SET_CHILD_SUBREAPER, 1) == 0) {
+            subreaper_ = true;
+            // 有proc connector时进程树由事件维护，不需要定期扫描
+            if (!proc_events_.isOpen()) {
+                timers_.schedulePeriodic(options_.descendant_scan_interval, [this] { refreshDescendants(); });
+            }
+        } else {
+            ELOG_WARN << "PR_SET_CHILD_SUBREAPER failed (errno " << errno << "), descendants will not be tracked";
+        }
+    }
+    
+    if (!options_.handle_signals) {
+        return;
+    }
+    
+    if (options_.mode == SupervisorMode::EVENT && loop_.isValid()) {
+        signal_fd_ = SignalHandler::createSignalFd();
+        if (signal_fd_ != -1 && !loop_.add(signal_fd_, [this](uint32_t) { onSignalReadable(); })) {
+            close(signal_fd_);
+            signal_fd_ = -1;
+        }
+        if (signal_fd_ != -1) {
+            return;
+        }
+        ELOG_WARN << "signalfd unavailable (errno " << errno << "), using sigaction handler";
+    }
     SignalHandler::setupShutdownHandler();
 }
 
+ProcessManager::Retired::~Retired() {
+    // 只有从事件循环中摘下它的一方关闭fd，避免与onPidfdReadable重复关闭
+    if (pidfd != -1 && (!loop || loop->remove(pidfd))) {
+        close(pidfd);
+    }
+}
+
 ProcessManager::~ProcessManager() {
     // shutdown();
+    drainEvents();
+    if (proc_events_.isOpen()) {
+        loop_.remove(proc_events_.fd());
+    }
+    if (executables_.isOpen()) {
+        loop_.remove(executables_.fd());
+    }
+    if (signal_fd_ != -1) {
+        loop_.remove(signal_fd_);
+        close(signal_fd_);
+    }
+    if (launch_options_.cgroup_fd != -1) {
+        close(launch_options_.cgroup_fd);
+    }
 }
 
-bool ProcessManager::addModule(const std::string& name, const std::string& command, bool auto_restart) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (processes_.count(name)) {
-        ELOG_ERROR << "Module [" << name << "] already exists";
+bool ProcessManager::addModule(const std::string& name, const std::string& command, bool auto_restart,
+                               const ModuleStdio& stdio, ShellMode shell) {
+    ProcessInfo info;
+    info.name = name;
+    info.command = command;
+    info.shell = shell;
+    info.auto_restart = auto_restart;
+    info.stdio = stdio;
+    return addModule(std::move(info));
+}
+
+bool ProcessManager::addModuleArgv(const std::string& name, const CommandArgs& argv, bool auto_restart,
+                                   const ModuleStdio& stdio) {
+    ProcessInfo info;
+    info.name = name;
+    info.argv = argv;
+    for (const auto& arg : argv) {
+        info.command += (info.command.empty() ? "" : " ") + arg;
+    }
+    info.auto_restart = auto_restart;
+    info.stdio = stdio;
+    return addModule(std::move(info));
+}
+
+bool ProcessManager::addModule(ProcessInfo info) {
+    // 编译可能读取source的文件，在锁外进行
+    ShellCommand compiled = compileModule(info);
+    if (!CommandParser::validateCommand(compiled.args)) {
+        ELOG_ERROR << "Invalid command for module [" << info.name << "]"
+                   << (info.shell == ShellMode::NEVER ? ", it needs a shell but shell is disabled" : "");
         return false;
     }
+    if (!compiled.interpreted) {
+        ELOG_DEBUG << "Module [" << info.name << "] runs via /bin/bash -c";
+    }
+    
+    // 只解析一次：之后每次启动、重启都直接使用预编译的启动计划。路径查找在锁外进行
+    Module module;
+    module.plan = LaunchPlan::build(compiled, info.stdio);
+    module.info = std::move(info);
     
-    auto args = CommandParser::parseCommand(command);
-    if (!CommandParser::validateCommand(args)) {
-        ELOG_ERROR << "Invalid command for module [" << name << "]";
+    std::unique_lock<TimedMutex> lock(mutex_);
+    if (ids_.count(module.info.name)) {
+        lock.unlock();
+        ELOG_ERROR << "Module [" << module.info.name << "] already exists";
         return false;
     }
     
-    ProcessInfo info;
-    info.name = name;
-    info.command = command;
-    info.auto_restart = auto_restart;
-    
-    processes_[name] = info;
+    if (executables_.isOpen()) {
+        executables_.watch(module.info.name, *module.plan);
+    }
+    ModuleId id = modules_.insert(std::move(module));
+    Module& added = *modules_.get(id);
+    added.info.id = id;
+    ids_.emplace(added.info.name, id);
+    changedLocked();
     return true;
 }
 
+ShellCommand ProcessManager::compileModule(const ProcessInfo& info) {
+    if (!info.argv.empty()) {
+        ShellCommand command;
+        command.args = info.argv;
+        return command;
+    }
+    return CommandParser::compile(info.command, info.shell);
+}
+
 bool ProcessManager::removeModule(const std::string& name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    pid_t terminate_pid = -1;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it == ids_.end()) {
+            return false;
+        }
+        
+        Module& module = *modules_.get(it->second);
+        ProcessInfo& info = module.info;
+        cancelRestart(module);
+        if (info.pid != -1) {
+            // RUNNING和STOPPING的进程都转入removed_，pidfd保持注册，退出后照常回收
+            pid_t pid = info.pid;
+            if (info.state == ProcessState::RUNNING) {
+                terminate_pid = pid;
+            }
+            if (module.kill_timer != TimerWheel::kInvalidTimer) {
+                timers_.cancel(module.kill_timer);
+                module.kill_timer = TimerWheel::kInvalidTimer;
+            }
+            RemovedProcess removed;
+            removed.name = info.name;
+            removed.pidfd = info.pidfd;
+            removed.kill_timer = timers_.schedule(options_.stop_timeout, [this, pid] { onRemovedStopTimeout(pid); });
+            removed_[pid] = std::move(removed);
+            pid_to_id_.erase(pid);
+            if (trackingDescendants()) {
+                descendants_.remove(pid);
+            }
+            info.pidfd = -1;
+            loop_.wakeup();
+        }
+        info.state = ProcessState::STOPPED;
+        LifecycleEvent stopped = eventLocked(LifecycleEvent::Type::STOPPED, info);
+        stopped.reason = LifecycleEvent::Reason::STOP_REQUESTED;
+        emitLocked(stopped);
+        
+        // 正在启动的进程由finishStartLocked发现句柄失效后终止
+        modules_.erase(it->second);
+        ids_.erase(it);
+        executables_.unwatch(name);
+        changedLocked();
+    }
     
-    auto it = processes_.find(name);
-    if (it == processes_.end()) {
+    if (terminate_pid > 0) {
+        ProcessLauncher::terminate(terminate_pid, SIGTERM);
+    }
+    drainEvents();
+    return true;
+}
+
+ModuleId ProcessManager::findModule(const std::string& name) const {
+    std::lock_guard<TimedMutex> lock(mutex_);
+    return findLocked(name);
+}
+
+ModuleId ProcessManager::findLocked(const std::string& name) const {
+    auto it = ids_.find(name);
+    return it != ids_.end() ? it->second : ModuleId{};
+}
+
+bool ProcessManager::startModule(const std::string& name) {
+    ModuleId id = findModule(name);
+    if (!id.valid()) {
+        ELOG_ERROR << "Module [" << name << "] not found";
+        return false;
+    }
+    return startModule(id);
+}
+
+bool ProcessManager::startModule(ModuleId id) {
+    PendingStart start;
+    bool prepared;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        prepared = prepareStartLocked(id, start);
+    }
+    if (!prepared) {
+        auto snapshot = this->snapshot();
+        const ProcessInfo* info = snapshot->find(id);
+        if (start.error == EALREADY && info) {
+            ELOG_ERROR << "Module [" << info->name << "] already running";
+        }
         return false;
     }
     
-    if (it->second.state == ProcessState::RUNNING) {
-        ProcessLauncher::terminate(it->second.pid, SIGTERM);
-        cleanupProcess(name);
+    // 创建进程时不持有锁，状态查询不会被fork阻塞
+    spawn(start);
+    
+    bool started;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        started = finishStartLocked(start);
+        if (starting_count_ == 0) {
+            early_exits_.clear();
+        }
+    }
+    drainEvents();
+    return started;
+}
+
+std::vector<StartResult> ProcessManager::startModules(std::span<const std::string> names) {
+    if (options_.warm_up) {
+        warmUp(names);
+    }
+    
+    std::vector<StartResult> results(names.size());
+    std::vector<PendingStart> starts(names.size());
+    std::vector<size_t> pending;
+    pending.reserve(names.size());
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        for (size_t i = 0; i < names.size(); ++i) {
+            results[i].name = names[i];
+            ModuleId id = findLocked(names[i]);
+            if (!id.valid()) {
+                ELOG_ERROR << "Module [" << names[i] << "] not found";
+                results[i].error = ESRCH;
+            } else if (prepareStartLocked(id, starts[i])) {
+                pending.push_back(i);
+            } else {
+                results[i].error = starts[i].error;
+            }
+        }
+    }
+    for (const auto& result : results) {
+        if (result.error == EALREADY) {
+            ELOG_ERROR << "Module [" << result.name << "] already running";
+        }
     }
     
-    processes_.erase(it);
-    return true;
+    // zygote本身是串行的，多线程没有意义
+    size_t workers = zygote_.isRunning() ? 1 : std::min(std::max<size_t>(options_.launch_threads, 1), pending.size());
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < pending.size();) {
+            spawn(starts[pending[k]]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    size_t started = 0;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        for (size_t i : pending) {
+            results[i].started = finishStartLocked(starts[i]);
+            results[i].pid = starts[i].pid.value_or(-1);
+            results[i].error = starts[i].error;
+            started += results[i].started ? 1 : 0;
+        }
+        if (starting_count_ == 0) {
+            early_exits_.clear();
+        }
+    }
+    drainEvents();
+    ELOG_INFO << "Started " << started << " of " << names.size() << " modules using " << workers
+              << (zygote_.isRunning() ? " zygote" : " launcher") << " thread(s)";
+    return results;
 }
 
-bool ProcessManager::startModule(const std::string& name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+std::vector<StartResult> ProcessManager::startAll() {
+    std::vector<std::string> names;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        names.reserve(modules_.size());
+        for (const auto& module : modules_) {
+            if (module.info.state == ProcessState::STOPPED || module.info.state == ProcessState::FAILED) {
+                names.push_back(module.info.name);
+            }
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return startModules(names);
+}
+
+size_t ProcessManager::warmUp(std::span<const std::string> names) {
+    std::vector<std::pair<ModuleId, std::shared_ptr<const LaunchPlan>>> plans;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        for (const auto& name : names) {
+            Module* module = modules_.get(findLocked(name));
+            if (module && module->plan->execFd() == -1) {
+                plans.emplace_back(module->info.id, module->plan);
+            }
+        }
+    }
     
-    auto it = processes_.find(name);
-    if (it == processes_.end()) {
-        ELOG_ERROR << "Module [" << name << "] not found";
+    // 文件I/O在锁外进行；同一批模块共用的库只预读一次
+    auto t0 = std::chrono::steady_clock::now();
+    BinaryWarmer warmer;
+    std::vector<std::shared_ptr<const LaunchPlan>> warmed(plans.size());
+    for (size_t i = 0; i < plans.size(); ++i) {
+        const LaunchPlan& plan = *plans[i].second;
+        int fd = warmer.warm(plan.path(), plan.cwd() ? plan.cwd() : "");
+        if (fd != -1) {
+            warmed[i] = plan.withExecFd(fd);
+        }
+    }
+    
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        for (size_t i = 0; i < plans.size(); ++i) {
+            Module* module = modules_.get(plans[i].first);
+            // 期间计划被重建（可执行文件变化）或模块被移除时丢弃，fd随warmed[i]关闭
+            if (warmed[i] && module && module->plan == plans[i].second) {
+                module->plan = warmed[i];
+            }
+        }
+    }
+    ELOG_INFO << "Warmed up " << plans.size() << " modules: " << warmer.files() << " files, "
+              << warmer.bytes() / 1024 << " KB in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count()
+              << "ms";
+    return warmer.files();
+}
+
+bool ProcessManager::prepareStartLocked(ModuleId id, PendingStart& start) {
+    start.id = id;
+    Module* module = modules_.get(id);
+    if (!module) {
+        start.error = ESRCH;
         return false;
     }
     
-    if (it->second.state == ProcessState::RUNNING) {
-        ELOG_ERROR << "Module [" << name << "] already running";
+    ProcessState state = module->info.state;
+    if (state == ProcessState::RUNNING || state == ProcessState::STOPPING || state == ProcessState::STARTING) {
+        start.error = EALREADY;     // 由调用者在锁外记录日志
         return false;
     }
+    cancelRestart(*module);
+    start.retired.loop = &loop_;
     
-    auto args = CommandParser::parseCommand(it->second.command);
-    auto pid = ProcessLauncher::launch(args);
+    module->info.state = ProcessState::STARTING;
+    changedLocked(id);
+    start.plan = module->plan;
+    ++starting_count_;
+    return true;
+}
+
+void ProcessManager::spawn(PendingStart& start) {
+    if (zygote_.isRunning()) {
+        start.pid = zygote_.launch(*start.plan, &start.pidfd);
+        // 只有连接断开才放弃zygote，其他错误按普通的启动失败处理
+        if (!start.pid && (errno == EPIPE || errno == ECONNRESET || errno == ECONNREFUSED)) {
+            ELOG_WARN << "Zygote is gone (" << std::strerror(errno) << "), launching directly";
+            zygote_.stop();
+        }
+    }
+    if (!zygote_.isRunning()) {
+        start.pid = ProcessLauncher::launch(*start.plan, launch_options_, &start.pidfd);
+    }
+    start.error = start.pid ? 0 : errno;
+    if (start.pid) {
+        // pid索引的节点在锁外分配，登记时只需挂入
+        PidMap scratch;
+        scratch.emplace(*start.pid, start.id);
+        start.pid_node = scratch.extract(scratch.begin());
+    }
+}
+
+bool ProcessManager::finishStartLocked(PendingStart& start) {
+    --starting_count_;
+    
+    Module* module = modules_.get(start.id);
+    if (!module) {
+        // 启动过程中模块被移除
+        if (start.pid) {
+            ProcessLauncher::terminate(*start.pid, SIGKILL);
+            if (!early_exits_.erase(*start.pid)) {
+                waitpid(*start.pid, nullptr, 0);
+            }
+        }
+        if (start.pidfd != -1) {
+            close(start.pidfd);
+        }
+        return false;
+    }
     
-    if (pid) {
-        it->second.pid = *pid;
-        it->second.state = ProcessState::RUNNING;
-        pid_to_name_[*pid] = name;
-        ELOG_INFO << "Started module [" << name << "] with PID " << *pid;
+    changedLocked(module->info.id);
+    ProcessInfo& info = module->info;
+    if (start.pid) {
+        pid_t pid = *start.pid;
+        info.pid = pid;
+        info.last_error = 0;
+        info.binary_replaced = false;
+        info.health = ModuleHealth::UNKNOWN;
+        info.state = ProcessState::RUNNING;
+        auto inserted = pid_to_id_.insert(std::move(start.pid_node));
+        if (!inserted.inserted) {
+            pid_to_id_[pid] = start.id;     // 同一pid的残留条目
+        }
+        if (trackingDescendants()) {
+            descendants_.addRoot(pid, info.name);
+        }
+        if (options_.mode == SupervisorMode::EVENT) {
+            watchChild(info, start.pidfd);
+        } else if (start.pidfd != -1) {
+            close(start.pidfd);
+        }
+        emitLocked(eventLocked(LifecycleEvent::Type::STARTED, info));
+        
+        // 登记之前已被waitpid(-1)回收的进程
+        auto early = early_exits_.find(pid);
+        if (early != early_exits_.end()) {
+            auto [status, usage] = early->second;
+            early_exits_.erase(early);
+            handleChildExitLocked(pid, status, &usage, start.retired);
+        }
         return true;
+    }
+    
+    info.last_error = start.error;
+    bool retry = false;
+    if (ProcessLauncher::isPermanentError(info.last_error)) {
+        // 重试也不会成功，不消耗重启次数，避免fork循环
+        info.state = ProcessState::FAILED;
+    } else if (info.auto_restart && !shutting_down_) {
+        info.restart_count++;
+        info.state = ProcessState::CRASHED;
+        retry = true;
     } else {
-        ELOG_ERROR << "Failed to start module [" << name << "]";
-        return false;
+        info.state = ProcessState::STOPPED;
+    }
+    LifecycleEvent failed = eventLocked(LifecycleEvent::Type::START_FAILED, info);
+    failed.error = info.last_error;
+    emitLocked(failed);
+    if (retry) {
+        scheduleRestart(*module, options_.restart_delay, LifecycleEvent::Reason::CRASHED);
+        loop_.wakeup();
     }
+    return false;
 }
 
 bool ProcessManager::stopModule(const std::string& name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    return stopModule(findModule(name));
+}
+
+bool ProcessManager::stopModule(ModuleId id) {
+    pid_t pid;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        
+        Module* module = modules_.get(id);
+        if (!module) {
+            return false;
+        }
+        
+        module->restart_after_stop = false;
+        if (cancelRestart(*module)) {
+            // 崩溃后等待重启中，取消重启即可
+            module->info.state = ProcessState::STOPPED;
+            changedLocked(id);
+            LifecycleEvent stopped = eventLocked(LifecycleEvent::Type::STOPPED, module->info);
+            stopped.reason = LifecycleEvent::Reason::STOP_REQUESTED;
+            emitLocked(stopped);
+            pid = 0;
+        } else {
+            pid = stopLocked(*module);
+        }
+    }
     
-    auto it = processes_.find(name);
-    if (it == processes_.end() || it->second.state != ProcessState::RUNNING) {
+    // 信号在锁外发送
+    if (pid > 0) {
+        ProcessLauncher::terminate(pid, SIGTERM);
+    }
+    drainEvents();
+    return pid != -1;
+}
+
+bool ProcessManager::restartModule(const std::string& name) {
+    ModuleId id = findModule(name);
+    if (!id.valid()) {
+        ELOG_ERROR << "Module [" << name << "] not found";
         return false;
     }
+    return restartModule(id);
+}
+
+bool ProcessManager::restartModule(ModuleId id) {
+    pid_t pid = -1;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        Module* module = modules_.get(id);
+        if (!module) {
+            return false;
+        }
+        
+        ProcessState state = module->info.state;
+        if (state == ProcessState::STOPPING) {
+            module->restart_after_stop = true;
+            return true;
+        }
+        if (state == ProcessState::RUNNING) {
+            // 退出事件到达后由onChildExit立即安排启动，无需等待
+            module->restart_after_stop = true;
+            pid = stopLocked(*module);
+        }
+    }
     
-    it->second.state = ProcessState::STOPPING;
-    it->second.auto_restart = false; // 防止自动重启
-    ProcessLauncher::terminate(it->second.pid, SIGTERM);
-    return true;
+    if (pid > 0) {
+        ProcessLauncher::terminate(pid, SIGTERM);
+        drainEvents();
+        return true;
+    }
+    return startModule(id);
 }
 
-bool ProcessManager::restartModule(const std::string& name) {
-    stopModule(name);
+pid_t ProcessManager::stopLocked(Module& module) {
+    ProcessInfo& info = module.info;
+    if (info.state != ProcessState::RUNNING) {
+        return -1;
+    }
     
-    // 等待进程真正停止
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // STOPPING状态的进程退出时不会被自动重启；SIGTERM由调用者在锁外发送
+    info.state = ProcessState::STOPPING;
+    changedLocked(info.id);
+    emitLocked(eventLocked(LifecycleEvent::Type::STOPPING, info));
     
-    return startModule(name);
+    // 超时未退出则升级为SIGKILL
+    ModuleId id = info.id;
+    pid_t pid = info.pid;
+    module.kill_timer = timers_.schedule(options_.stop_timeout, [this, id, pid] {
+        onStopTimeout(id, pid);
+    });
+    loop_.wakeup();
+    return pid;
 }
 
-void ProcessManager::onChildExit(pid_t pid, int status) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    ELOG_INFO << "Child process with PID " << pid << " exited with status " << status;
-    
-    auto pid_it = pid_to_name_.find(pid);
-    if (pid_it == pid_to_name_.end()) {
+void ProcessManager::onChildExit(pid_t pid, int status, const struct rusage* usage) {
+    ELOG_DEBUG << "Child process with PID " << pid << " exited with status " << status;
+    // 摘下的pidfd和pid索引节点在解锁之后才释放
+    Retired retired(&loop_);
+    std::lock_guard<TimedMutex> lock(mutex_);
+    handleChildExitLocked(pid, status, usage, retired);
+}
+
+void ProcessManager::handleChildExitLocked(pid_t pid, int status, const struct rusage* usage, Retired& retired) {
+    auto pid_it = pid_to_id_.find(pid);
+    if (pid_it == pid_to_id_.end()) {
+        auto removed = removed_.find(pid);
+        if (removed != removed_.end()) {
+            // 已移除模块的进程：只释放资源，不再产生模块事件
+            retired.pidfd = removed->second.pidfd;
+            if (removed->second.kill_timer != TimerWheel::kInvalidTimer) {
+                timers_.cancel(removed->second.kill_timer);
+            }
+            if (subreaper_) {
+                adoptOrphansLocked(pid, removed->second.name);
+                terminateDescendants(removed->second.name);
+            }
+            removed_.erase(removed);
+            return;
+        }
+        if (starting_count_ > 0 && !(trackingDescendants() && descendants_.contains(pid))) {
+            // 可能是尚未登记的新进程，留给finishStartLocked处理
+            early_exits_[pid] = {status, usage ? *usage : rusage{}};
+            return;
+        }
+        if (subreaper_) {
+            onDescendantExit(pid, status);
+        }
         return;
     }
     
-    const std::string& name = pid_it->second;
-    auto proc_it = processes_.find(name);
-    if (proc_it == processes_.end()) {
+    Module* module = modules_.get(pid_it->second);
+    if (!module) {
+        pid_to_id_.erase(pid_it);
         return;
     }
     
-    ProcessInfo& info = proc_it->second;
-    ELOG_INFO << "Module [" << name << "] with PID " << pid << " exited"
-              << (WIFEXITED(status) ? " with code " + std::to_string(WEXITSTATUS(status)) : 
-                  WIFSIGNALED(status) ? " by signal " + std::to_string(WTERMSIG(status)) : "");
+    changedLocked(module->info.id);
+    ProcessInfo& info = module->info;
+    if (usage) {
+        info.last_rusage = *usage;
+    }
+    LifecycleEvent exited = eventLocked(LifecycleEvent::Type::EXITED, info);
+    exited.pid = pid;
+    exited.status = status;
+    exited.usage = info.last_rusage;
+    emitLocked(exited);
     
     bool was_stopping = (info.state == ProcessState::STOPPING);
-    cleanupProcess(name);
+    bool restart_requested = module->restart_after_stop;
+    module->restart_after_stop = false;
+    cleanupProcess(*module, &retired);
+    if (subreaper_) {
+        // 主进程（例如bash包装）退出后，残留的后代进程已过继给管理器，包括增量刷新还没发现的
+        adoptOrphansLocked(pid, info.name);
+    }
+    if (trackingDescendants()) {
+        descendants_.remove(pid);
+    }
+    if (subreaper_) {
+        terminateDescendants(info.name);
+    }
     
     // 在shutdown过程中不重启
-    if (!shutting_down_ && info.auto_restart && !was_stopping) {
+    if (!shutting_down_ && restart_requested) {
+        scheduleRestart(*module, std::chrono::milliseconds(0), LifecycleEvent::Reason::REQUESTED);
+    } else if (!shutting_down_ && info.auto_restart && !was_stopping) {
+        // 每个模块独立的重启定时器，多个模块同时崩溃时并行等待
         info.restart_count++;
-        ELOG_INFO << "Auto-restarting module [" << name << "] (attempt " << info.restart_count << ")";
-        
-        // 重启逻辑：先记录需要重启的模块，在锁外处理
-        restart_queue_.push_back(name);
+        info.state = ProcessState::CRASHED;
+        scheduleRestart(*module, options_.restart_delay, LifecycleEvent::Reason::CRASHED);
     } else {
-        ELOG_INFO << "Module [" << name << "] will not be restarted"
-                  << (shutting_down_ ? " (shutting down)" : 
-                      !info.auto_restart ? " (auto_restart disabled)" :
-                      was_stopping ? " (was stopping)" : "");
         info.state = ProcessState::STOPPED;
+        LifecycleEvent stopped = eventLocked(LifecycleEvent::Type::STOPPED, info);
+        stopped.reason = shutting_down_ ? LifecycleEvent::Reason::SHUTTING_DOWN :
+                         !info.auto_restart ? LifecycleEvent::Reason::AUTO_RESTART_DISABLED :
+                         LifecycleEvent::Reason::STOP_REQUESTED;
+        emitLocked(stopped);
     }
 }
 
 void ProcessManager::shutdown() {
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<TimedMutex> lock(mutex_);
         if (shutting_down_) {
             return; // 避免重复调用
         }
@@ -162,16 +724,47 @@ void ProcessManager::shutdown() {
     
     ELOG_INFO << "Shutting down process manager...";
     
-    // 收集需要终止的进程ID
+    // 收集需要终止的进程ID，取消所有等待中的重启和SIGKILL定时器
     std::vector<pid_t> pids_to_terminate;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (auto& [name, info] : processes_) {
-            if (info.state == ProcessState::RUNNING && info.pid != -1) {
-                ELOG_INFO << "Marking module [" << name << "] for termination";
+        std::lock_guard<TimedMutex> lock(mutex_);
+        for (auto& module : modules_) {
+            ProcessInfo& info = module.info;
+            cancelRestart(module);
+            if ((info.state == ProcessState::RUNNING || info.state == ProcessState::STOPPING) &&
+                info.pid != -1) {
                 info.state = ProcessState::STOPPING;
                 info.auto_restart = false; // 禁止自动重启
                 pids_to_terminate.push_back(info.pid);
+                LifecycleEvent stopping = eventLocked(LifecycleEvent::Type::STOPPING, info);
+                stopping.reason = LifecycleEvent::Reason::SHUTTING_DOWN;
+                emitLocked(stopping);
+            }
+            if (module.kill_timer != TimerWheel::kInvalidTimer) {
+                timers_.cancel(module.kill_timer);
+                module.kill_timer = TimerWheel::kInvalidTimer;
+            }
+            module.restart_after_stop = false;
+        }
+        for (auto& [pid, removed] : removed_) {
+            if (removed.kill_timer != TimerWheel::kInvalidTimer) {
+                timers_.cancel(removed.kill_timer);
+                removed.kill_timer = TimerWheel::kInvalidTimer;
+            }
+            pids_to_terminate.push_back(pid);
+        }
+        changedLocked();
+    }
+    drainEvents();
+    
+    // 后代进程与主进程一起收到SIGTERM
+    std::vector<pid_t> descendant_pids;
+    if (subreaper_) {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        descendants_.refresh();
+        for (pid_t pid : descendants_.all()) {
+            if (!descendants_.isRoot(pid)) {
+                descendant_pids.push_back(pid);
             }
         }
     }
@@ -180,22 +773,66 @@ void ProcessManager::shutdown() {
     for (pid_t pid : pids_to_terminate) {
         ProcessLauncher::terminate(pid, SIGTERM);
     }
+    for (pid_t pid : descendant_pids) {
+        ProcessLauncher::terminate(pid, SIGTERM);
+    }
     
-    // 等待一小段时间后强制终止
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    // 等待子进程退出，所有进程退出后立即返回，超时后强制终止
+    auto deadline = std::chrono::steady_clock::now() + options_.stop_timeout;
+    bool event_driven = options_.mode == SupervisorMode::EVENT && pidfd_supported_;
+    for (;;) {
+        reapOwned(pids_to_terminate);
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (pids_to_terminate.empty() || remaining.count() <= 0) {
+            break;
+        }
+        // EVENT模式下pidfd可读会立即唤醒；否则以较短间隔检查
+        loop_.runOnce(static_cast<int>(event_driven ? remaining.count() : std::min<long>(remaining.count(), 10)));
+    }
     
     for (pid_t pid : pids_to_terminate) {
+        ELOG_WARN << "PID " << pid << " did not exit in " << options_.stop_timeout.count() << "ms, sending SIGKILL";
         ProcessLauncher::terminate(pid, SIGKILL);
+        int status;
+        struct rusage usage {};
+        if (wait4(pid, &status, 0, &usage) == pid) {
+            onChildExit(pid, status, &usage);
+        }
+    }
+    
+    // 仍然存活的后代进程强制终止；过继给管理器的直接回收
+    for (pid_t pid : descendant_pids) {
+        if (ProcessLauncher::isProcessAlive(pid)) {
+            ProcessLauncher::terminate(pid, SIGKILL);
+        }
+        int status;
+        if (waitpid(pid, &status, 0) == pid) {
+            onChildExit(pid, status);
+        }
     }
     
     // 清理数据结构
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        processes_.clear();
-        pid_to_name_.clear();
-        restart_queue_.clear();
+        std::lock_guard<TimedMutex> lock(mutex_);
+        for (auto& module : modules_) {
+            cleanupProcess(module);
+        }
+        modules_.clear();
+        ids_.clear();
+        changedLocked();
+        executables_.clear();
+        pid_to_id_.clear();
+        for (auto& [pid, removed] : removed_) {
+            if (removed.pidfd != -1 && loop_.remove(removed.pidfd)) {
+                close(removed.pidfd);
+            }
+        }
+        removed_.clear();
+        descendants_.clear();
     }
     
+    drainEvents();
     ELOG_INFO << "Process manager shutdown complete";
     easylog::flush();
 }
@@ -206,32 +843,321 @@ bool ProcessManager::shouldExit() const {
 }
 
 void ProcessManager::processRestartQueue() {
-    // 如果正在关闭，不处理重启队列
-    if (shutting_down_) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        restart_queue_.clear();
+    processTimers();
+}
+
+void ProcessManager::processTimers() {
+    std::vector<TimerWheel::Callback> due;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        timers_.advance(TimerWheel::Clock::now(), due);
+    }
+    
+    // 在锁外执行回调，回调中可以再次加锁
+    for (auto& callback : due) {
+        callback();
+    }
+}
+
+TimerWheel::TimerId ProcessManager::schedulePeriodic(std::chrono::milliseconds interval,
+                                                     std::function<void()> task) {
+    std::lock_guard<TimedMutex> lock(mutex_);
+    auto id = timers_.schedulePeriodic(interval, std::move(task));
+    loop_.wakeup();
+    return id;
+}
+
+void ProcessManager::post(std::function<void()> task) {
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        timers_.schedule(std::chrono::milliseconds(0), std::move(task));
+    }
+    loop_.wakeup();
+}
+
+bool ProcessManager::cancelTimer(TimerWheel::TimerId id) {
+    std::lock_guard<TimedMutex> lock(mutex_);
+    return timers_.cancel(id);
+}
+
+void ProcessManager::scheduleRestart(Module& module, std::chrono::milliseconds delay,
+                                     LifecycleEvent::Reason reason) {
+    cancelRestart(module);
+    // 回调只捕获句柄，不复制模块名
+    ModuleId id = module.info.id;
+    module.restart_timer = timers_.schedule(delay, [this, id] { onRestartTimer(id); });
+    LifecycleEvent scheduled = eventLocked(LifecycleEvent::Type::RESTART_SCHEDULED, module.info);
+    scheduled.reason = reason;
+    scheduled.delay_ms = delay.count();
+    emitLocked(scheduled);
+}
+
+bool ProcessManager::cancelRestart(Module& module) {
+    if (module.restart_timer == TimerWheel::kInvalidTimer) {
+        return false;
+    }
+    timers_.cancel(module.restart_timer);
+    module.restart_timer = TimerWheel::kInvalidTimer;
+    return true;
+}
+
+void ProcessManager::onRestartTimer(ModuleId id) {
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        // 定时器到期后、回调执行前被stopModule取消或模块被移除的情况
+        Module* module = modules_.get(id);
+        if (shutting_down_ || !module || module->restart_timer == TimerWheel::kInvalidTimer) {
+            return;
+        }
+        module->restart_timer = TimerWheel::kInvalidTimer;
+    }
+    startModule(id);
+}
+
+void ProcessManager::onStopTimeout(ModuleId id, pid_t pid) {
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        Module* module = modules_.get(id);
+        if (!module) {
+            return;
+        }
+        module->kill_timer = TimerWheel::kInvalidTimer;
+        if (module->info.pid != pid || module->info.state != ProcessState::STOPPING) {
+            return;
+        }
+        LifecycleEvent killed = eventLocked(LifecycleEvent::Type::KILLED, module->info);
+        killed.delay_ms = options_.stop_timeout.count();
+        emitLocked(killed);
+    }
+    ProcessLauncher::terminate(pid, SIGKILL);
+}
+
+void ProcessManager::onRemovedStopTimeout(pid_t pid) {
+    std::string name;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        auto removed = removed_.find(pid);
+        if (removed == removed_.end()) {
+            return;
+        }
+        removed->second.kill_timer = TimerWheel::kInvalidTimer;
+        name = removed->second.name;
+    }
+    ELOG_WARN << "Removed module [" << name << "] PID " << pid << " did not exit in "
+              << options_.stop_timeout.count() << "ms, sending SIGKILL";
+    ProcessLauncher::terminate(pid, SIGKILL);
+}
+
+void ProcessManager::refreshDescendants() {
+    std::lock_guard<TimedMutex> lock(mutex_);
+    size_t added = descendants_.refresh();
+    if (added > 0) {
+        ELOG_DEBUG << "Discovered " << added << " new descendant processes";
+        changedLocked();
+    }
+    pruneDescendants();
+}
+
+void ProcessManager::pruneDescendants() {
+    for (pid_t pid : descendants_.all()) {
+        if (descendants_.isRoot(pid)) {
+            continue;
+        }
+        int status;
+        pid_t ret = waitpid(pid, &status, WNOHANG);
+        if (ret == pid) {
+            // 过继给管理器的孤儿进程已退出（没有signalfd/轮询时也能及时回收）
+            onDescendantExit(pid, status);
+        } else if (ret == -1 && !ProcessLauncher::isProcessAlive(pid)) {
+            // 由其他父进程回收的后代
+            changedLocked(findLocked(descendants_.remove(pid)));
+        }
+    }
+}
+
+void ProcessManager::onDescendantExit(pid_t pid, int status) {
+    if (!descendants_.contains(pid)) {
+        return;
+    }
+    std::string module = descendants_.remove(pid);
+    changedLocked(findLocked(module));
+    ELOG_INFO << "Reaped orphaned descendant PID " << pid << " of module [" << module << "]"
+              << (WIFEXITED(status) ? ", exit code " + std::to_string(WEXITSTATUS(status)) :
+                  WIFSIGNALED(status) ? ", signal " + std::to_string(WTERMSIG(status)) : "");
+    if (Module* owner = modules_.get(findLocked(module))) {
+        owner->info.orphans_reaped++;
+    }
+}
+
+void ProcessManager::adoptOrphansLocked(pid_t root, const std::string& name) {
+    size_t adopted = descendants_.adoptOrphans(getpid(), root, name);
+    if (adopted > 0) {
+        ELOG_DEBUG << "Adopted " << adopted << " orphan(s) of module [" << name << "] by process group";
+        changedLocked(findLocked(name));
+    }
+}
+
+void ProcessManager::terminateDescendants(const std::string& name) {
+    descendants_.refresh();
+    auto pids = descendants_.descendantsOf(name);
+    if (pids.empty()) {
         return;
     }
     
-    std::vector<std::string> to_restart;
+    ELOG_INFO << "Terminating " << pids.size() << " leftover descendant(s) of module [" << name << "]";
+    for (pid_t pid : pids) {
+        ProcessLauncher::terminate(pid, SIGTERM);
+    }
+    timers_.schedule(options_.stop_timeout, [this, pids] {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        // 先清理已退出的进程，避免PID复用后误杀
+        pruneDescendants();
+        for (pid_t pid : pids) {
+            if (descendants_.contains(pid)) {
+                ProcessLauncher::terminate(pid, SIGKILL);
+            }
+        }
+    });
+}
+
+void ProcessManager::onProcEventsReadable() {
+    // 全系统的cn_proc消息在锁外读取、解析，锁内只按模块进程树过滤；
+    // proc_events_mutex_保证多个线程运行事件循环时事件仍按顺序应用
+    std::lock_guard<std::mutex> read_lock(proc_events_mutex_);
+    proc_event_buffer_.clear();
+    bool complete = proc_events_.readEvents([this](const ProcEvent& event) { proc_event_buffer_.push_back(event); });
+    if (!complete) {
+        ELOG_WARN << "Proc connector dropped events, resyncing descendants from /proc";
+    }
     
-    // 获取需要重启的模块列表
+    std::lock_guard<TimedMutex> lock(mutex_);
+    for (const ProcEvent& event : proc_event_buffer_) {
+        onProcEvent(event);
+    }
+    if (!complete) {
+        descendants_.refresh();
+    }
+}
+
+void ProcessManager::onExecutablesReadable() {
+    std::vector<ProcessInfo> changed;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        to_restart = std::move(restart_queue_);
-        restart_queue_.clear();
+        std::lock_guard<TimedMutex> lock(mutex_);
+        executables_.readEvents([&](const std::string& name) {
+            if (const Module* module = modules_.get(findLocked(name))) {
+                changed.push_back(module->info);
+            }
+        });
     }
     
-    // 在锁外重启模块
-    for (const auto& name : to_restart) {
-        if (shutting_down_) {
-            break; // 如果在重启过程中收到shutdown信号，立即停止
+    // 重新编译（按当时的PATH解析路径）在锁外进行，之后的启动直接使用新计划
+    for (const auto& module : changed) {
+        const std::string& name = module.name;
+        const std::string& command = module.command;
+        auto plan = LaunchPlan::build(compileModule(module), module.stdio);
+        std::lock_guard<TimedMutex> lock(mutex_);
+        Module* current = modules_.get(module.id);
+        if (!plan || !current || current->info.command != command) {
+            continue;
+        }
+        
+        std::string old_path = current->plan->path();
+        current->plan = plan;
+        if (!executables_.watch(name, *plan)) {
+            continue;
+        }
+        if (old_path != plan->path()) {
+            ELOG_INFO << "Executable of module [" << name << "] now resolves to " << plan->path();
+        } else {
+            ELOG_WARN << "Executable of module [" << name << "] changed on disk: " << plan->path();
+        }
+        if (current->info.state == ProcessState::RUNNING) {
+            // 运行中的进程仍是旧文件，下次启动时使用新文件
+            current->info.binary_replaced = true;
+            changedLocked(current->info.id);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        startModule(name);
     }
 }
 
+void ProcessManager::onProcEvent(const ProcEvent& event) {
+    // 全系统的事件中只处理模块进程树内的进程，查找为O(1)
+    const std::string* module = descendants_.moduleOf(
+        event.type == ProcEvent::Type::FORK ? event.parent : event.pid);
+    if (!module) {
+        return;
+    }
+    
+    Module* owner = modules_.get(findLocked(*module));
+    changedLocked(owner ? owner->info.id : ModuleId{});
+    switch (event.type) {
+        case ProcEvent::Type::FORK:
+            if (owner) {
+                owner->info.forks++;
+            }
+            descendants_.add(event.pid, *module);
+            break;
+        case ProcEvent::Type::EXEC:
+            if (owner) {
+                owner->info.execs++;
+            }
+            break;
+        case ProcEvent::Type::EXIT:
+            if (descendants_.isRoot(event.pid)) {
+                break;  // 主进程由pidfd/waitpid处理
+            }
+            if (owner) {
+                owner->info.descendant_exits++;
+            }
+            // 过继给管理器的进程留到waitpid回收时再移除
+            if (event.parent != getpid()) {
+                descendants_.remove(event.pid);
+            }
+            break;
+    }
+}
+
+void ProcessManager::reapOwned(std::vector<pid_t>& pids) {
+    for (auto it = pids.begin(); it != pids.end();) {
+        if (reapChild(*it) == 0) {
+            ++it;
+            continue;
+        }
+        // -1：已在事件回调中回收
+        it = pids.erase(it);
+    }
+}
+
+pid_t ProcessManager::reapChild(pid_t pid) {
+    int pidfd = -1;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        auto pid_it = pid_to_id_.find(pid);
+        if (pid_it != pid_to_id_.end()) {
+            if (const Module* module = modules_.get(pid_it->second)) {
+                pidfd = module->info.pidfd;
+            }
+        } else if (auto removed = removed_.find(pid); removed != removed_.end()) {
+            pidfd = removed->second.pidfd;
+        }
+        // 解锁后原fd可能被事件回调关闭并复用为别的文件，锁外只使用自己的副本。
+        // 复制失败时按pid回收：子进程被回收之前pid不会被复用
+        if (pidfd != -1) {
+            pidfd = fcntl(pidfd, F_DUPFD_CLOEXEC, 0);
+        }
+    }
+    
+    int status = 0;
+    struct rusage usage {};
+    pid_t ret = ProcessLauncher::reap(pid, pidfd, &status, &usage);
+    if (pidfd != -1) {
+        close(pidfd);
+    }
+    if (ret > 0) {
+        onChildExit(pid, status, &usage);
+    }
+    return ret;
+}
+
 void ProcessManager::checkChildProcesses() {
     // 如果正在关闭，不检查子进程（避免与shutdown冲突）
     if (shutting_down_) {
@@ -240,50 +1166,525 @@ void ProcessManager::checkChildProcesses() {
     
     int status;
     pid_t pid;
+    struct rusage usage {};
+    
+    if (!options_.reap_owned_only) {
+        // 非阻塞地检查是否有子进程退出
+        while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0) {
+            onChildExit(pid, status, &usage);
+        }
+        return;
+    }
+    
+    // 只回收自己的进程：pidfd可用时每个退出都有独立事件，无需扫描模块
+    std::vector<pid_t> owned;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        if (subreaper_) {
+            pruneDescendants();
+        }
+        if (options_.mode == SupervisorMode::EVENT && pidfd_supported_) {
+            return;
+        }
+        owned.reserve(pid_to_id_.size() + removed_.size());
+        for (const auto& [owned_pid, id] : pid_to_id_) {
+            owned.push_back(owned_pid);
+        }
+        for (const auto& [owned_pid, removed] : removed_) {
+            owned.push_back(owned_pid);
+        }
+    }
+    for (pid_t owned_pid : owned) {
+        reapChild(owned_pid);
+    }
+}
+
+void ProcessManager::runOnce(int timeout_ms) {
+    // pidfd不可用时若有signalfd，SIGCHLD会触发回收，无需定时轮询
+    bool polling = options_.mode == SupervisorMode::POLLING ||
+                   (!pidfd_supported_ && signal_fd_ == -1);
+    if (polling && (timeout_ms < 0 || timeout_ms > kPollIntervalMs)) {
+        timeout_ms = kPollIntervalMs;
+    }
+    
+    // 不晚于最近的定时器醒来
+    int timer_timeout;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        timer_timeout = timers_.nextTimeoutMs(TimerWheel::Clock::now());
+    }
+    if (timer_timeout >= 0 && (timeout_ms < 0 || timer_timeout < timeout_ms)) {
+        timeout_ms = timer_timeout;
+    }
+    
+    // EVENT模式下子进程退出会唤醒epoll，回调中直接完成回收
+    loop_.runOnce(timeout_ms);
+    
+    if (polling) {
+        checkChildProcesses();
+    }
+    processTimers();
+    drainEvents();
+    
+    // 启动、重启都完成之后再发布快照，复制不会推迟它们；读取者之后拿到的快照不需要重建
+    if (snapshot_read_.load(std::memory_order_relaxed)) {
+        snapshot();
+    }
+}
+
+void ProcessManager::watchChild(ProcessInfo& info, int pidfd) {
+    if (pidfd == -1) {
+        pidfd = ProcessLauncher::openPidfd(info.pid);
+    }
+    if (pidfd == -1) {
+        ELOG_WARN << "pidfd_open failed for PID " << info.pid << " (errno " << errno
+                  << "), falling back to polling";
+        pidfd_supported_ = false;
+        return;
+    }
+    
+    pid_t pid = info.pid;
+    if (!loop_.add(pidfd, [this, pid, pidfd](uint32_t) { onPidfdReadable(pid, pidfd); })) {
+        close(pidfd);
+        pidfd_supported_ = false;
+        return;
+    }
+    info.pidfd = pidfd;
+}
+
+void ProcessManager::onPidfdReadable(pid_t pid, int pidfd) {
+    if (reapChild(pid) != -1) {
+        return;
+    }
+    int error = errno;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        if (!ownsPidfdLocked(pid, pidfd)) {
+            // 不再属于任何进程的注册（epoll为水平触发，不摘下会一直可读）
+            if (loop_.remove(pidfd)) {
+                close(pidfd);
+            }
+            return;
+        }
+    }
+    // 仍登记的进程已被其他代码回收，退出状态未知，但进程确实已经结束
+    ELOG_WARN << "Child PID " << pid << " was reaped elsewhere (errno " << error << ")";
+    onChildExit(pid, 0);
+}
+
+bool ProcessManager::ownsPidfdLocked(pid_t pid, int pidfd) const {
+    auto pid_it = pid_to_id_.find(pid);
+    if (pid_it != pid_to_id_.end()) {
+        const Module* module = modules_.get(pid_it->second);
+        return module && module->info.pidfd == pidfd;
+    }
+    auto removed = removed_.find(pid);
+    return removed != removed_.end() && removed->second.pidfd == pidfd;
+}
+
+void ProcessManager::setSignalCallback(int signo, std::function<void()> callback) {
+    std::lock_guard<TimedMutex> lock(mutex_);
+    signal_callbacks_[signo] = std::move(callback);
+}
+
+void ProcessManager::onSignalReadable() {
+    int signo;
+    while ((signo = SignalHandler::readSignal(signal_fd_)) > 0) {
+        switch (signo) {
+            case SIGCHLD:
+                checkChildProcesses();
+                break;
+            case SIGINT:
+            case SIGTERM:
+                ELOG_INFO << "Received signal " << signo << ", requesting shutdown";
+                SignalHandler::requestShutdown();
+                break;
+            default:
+                break;
+        }
+        
+        std::function<void()> callback;
+        {
+            std::lock_guard<TimedMutex> lock(mutex_);
+            auto it = signal_callbacks_.find(signo);
+            if (it != signal_callbacks_.end()) {
+                callback = it->second;
+            }
+        }
+        if (callback) {
+            callback();
+        }
+    }
+}
+
+void ProcessManager::cleanupProcess(Module& module, Retired* retired) {
+    ProcessInfo& info = module.info;
+    if (info.pid != -1) {
+        if (retired) {
+            retired->pid_node = pid_to_id_.extract(info.pid);
+        } else {
+            pid_to_id_.erase(info.pid);
+        }
+    }
+    if (info.pidfd != -1) {
+        if (retired) {
+            retired->pidfd = info.pidfd;
+        } else if (loop_.remove(info.pidfd)) {
+            close(info.pidfd);
+        }
+        info.pidfd = -1;
+    }
+    if (module.kill_timer != TimerWheel::kInvalidTimer) {
+        timers_.cancel(module.kill_timer);
+        module.kill_timer = TimerWheel::kInvalidTimer;
+    }
+    info.pid = -1;
+    info.state = ProcessState::STOPPED;
+}
+
+LifecycleEvent ProcessManager::eventLocked(LifecycleEvent::Type type, const ProcessInfo& info) {
+    LifecycleEvent event;
+    event.type = type;
+    event.state = info.state;
+    event.id = info.id;
+    event.seq = ++event_seq_;
+    event.pid = info.pid;
+    event.restart_count = info.restart_count;
+    event.setName(info.name);
+    return event;
+}
+
+void ProcessManager::emitLocked(const LifecycleEvent& event) {
+    // 队列的块在构造时预先分配，消费跟得上时不分配内存
+    events_.enqueue(event_producer_, event);
     
-    // 非阻塞地检查是否有子进程退出
-    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
-        onChildExit(pid, status);
+    bool woken = false;
+    for (StateWaiter* waiter : waiters_) {
+        if (waiter->id != event.id) {
+            continue;
+        }
+        if (waiter->pid > 0 ? event.type == LifecycleEvent::Type::EXITED && event.pid == waiter->pid :
+                              event.type != LifecycleEvent::Type::EXITED && event.state == waiter->state) {
+            waiter->done = true;
+            woken = true;
+        }
     }
+    if (woken) {
+        state_changed_.notify_all();
+    }
+}
+
+bool ProcessManager::waitForState(const std::string& name, ProcessState state,
+                                  std::chrono::steady_clock::time_point deadline) {
+    return waitForState(findModule(name), state, deadline);
+}
+
+bool ProcessManager::waitForState(ModuleId id, ProcessState state, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<TimedMutex> lock(mutex_);
+    const Module* module = modules_.get(id);
+    if (!module) {
+        return false;
+    }
+    if (module->info.state == state) {
+        return true;
+    }
+    StateWaiter waiter;
+    waiter.id = id;
+    waiter.state = state;
+    return waitLocked(lock, waiter, deadline);
+}
+
+bool ProcessManager::waitForExit(const std::string& name, std::chrono::steady_clock::time_point deadline) {
+    return waitForExit(findModule(name), deadline);
 }
 
-void ProcessManager::cleanupProcess(const std::string& name) {
-    auto it = processes_.find(name);
-    if (it != processes_.end()) {
-        if (it->second.pid != -1) {
-            pid_to_name_.erase(it->second.pid);
+bool ProcessManager::waitForExit(ModuleId id, std::chrono::steady_clock::time_point deadline) {
+    pid_t pid;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        const Module* module = modules_.get(id);
+        if (!module) {
+            return false;
         }
-        it->second.pid = -1;
-        it->second.state = ProcessState::STOPPED;
+        pid = module->info.pid;
+    }
+    return pid <= 0 || waitForExit(id, pid, deadline);
+}
+
+bool ProcessManager::waitForExit(ModuleId id, pid_t pid, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<TimedMutex> lock(mutex_);
+    const Module* module = modules_.get(id);
+    if (!module) {
+        return false;
+    }
+    if (module->info.pid != pid) {
+        return true;    // 已退出（之后可能已重新启动）
     }
+    StateWaiter waiter;
+    waiter.id = id;
+    waiter.pid = pid;
+    return waitLocked(lock, waiter, deadline);
+}
+
+bool ProcessManager::waitLocked(std::unique_lock<TimedMutex>& lock, StateWaiter& waiter,
+                                std::chrono::steady_clock::time_point deadline) {
+    waiters_.push_back(&waiter);
+    state_changed_.wait_until(lock, deadline, [&] { return waiter.done || !modules_.contains(waiter.id); });
+    std::erase(waiters_, &waiter);
+    return waiter.done;
+}
+
+void ProcessManager::drainEvents() {
+    // 同一时刻只有一个消费者，日志和订阅者看到的事件保持顺序。
+    // 拿不到drain_mutex_的线程只留下标记：消费者在解锁后检查标记，
+    // 避免它最后一次出队之后、解锁之前推入的事件留在队列中无人处理
+    drain_pending_.store(true);
+    constexpr size_t kBatch = 16;
+    LifecycleEvent batch[kBatch];
+    while (drain_pending_.load()) {
+        std::unique_lock<std::mutex> lock(drain_mutex_, std::try_to_lock);
+        if (!lock) {
+            return;
+        }
+        drain_pending_.exchange(false);
+        size_t count;
+        while ((count = events_.try_dequeue_bulk_from_producer(event_producer_, batch, kBatch)) > 0) {
+            bus_.publish(batch, count);
+            for (size_t i = 0; i < count; ++i) {
+                logEvent(batch[i]);
+            }
+        }
+    }
+}
+
+void ProcessManager::logEvent(const LifecycleEvent& event) const {
+    const char* name = event.name;
+    switch (event.type) {
+        case LifecycleEvent::Type::STARTED:
+            ELOG_INFO << "Started module [" << name << "] with PID " << event.pid;
+            break;
+        case LifecycleEvent::Type::START_FAILED:
+            ELOG_ERROR << "Failed to start module [" << name << "]: " << std::strerror(event.error)
+                       << (event.state == ProcessState::FAILED ? ", marking as FAILED" : "");
+            break;
+        case LifecycleEvent::Type::EXITED:
+            if (WIFEXITED(event.status)) {
+                ELOG_INFO << "Module [" << name << "] with PID " << event.pid << " exited with code "
+                          << WEXITSTATUS(event.status);
+            } else if (WIFSIGNALED(event.status)) {
+                ELOG_INFO << "Module [" << name << "] with PID " << event.pid << " exited by signal "
+                          << WTERMSIG(event.status);
+            } else {
+                ELOG_INFO << "Module [" << name << "] with PID " << event.pid << " exited";
+            }
+            ELOG_DEBUG << "Module [" << name << "] usage: user "
+                       << event.usage.ru_utime.tv_sec * 1000 + event.usage.ru_utime.tv_usec / 1000
+                       << "ms, sys " << event.usage.ru_stime.tv_sec * 1000 + event.usage.ru_stime.tv_usec / 1000
+                       << "ms, maxrss " << event.usage.ru_maxrss << "KB";
+            break;
+        case LifecycleEvent::Type::RESTART_SCHEDULED:
+            if (event.reason == LifecycleEvent::Reason::REQUESTED) {
+                ELOG_INFO << "Restarting module [" << name << "]";
+            } else {
+                ELOG_INFO << "Auto-restarting module [" << name << "] in " << event.delay_ms
+                          << "ms (attempt " << event.restart_count << ")";
+            }
+            break;
+        case LifecycleEvent::Type::STOPPING:
+            if (event.reason == LifecycleEvent::Reason::SHUTTING_DOWN) {
+                ELOG_INFO << "Marking module [" << name << "] for termination";
+            } else {
+                ELOG_DEBUG << "Stopping module [" << name << "] with PID " << event.pid;
+            }
+            break;
+        case LifecycleEvent::Type::KILLED:
+            ELOG_WARN << "Module [" << name << "] did not exit in " << event.delay_ms << "ms, sending SIGKILL";
+            break;
+        case LifecycleEvent::Type::STOPPED:
+            ELOG_INFO << "Module [" << name << "] will not be restarted"
+                      << (event.reason == LifecycleEvent::Reason::SHUTTING_DOWN ? " (shutting down)" :
+                          event.reason == LifecycleEvent::Reason::AUTO_RESTART_DISABLED ? " (auto_restart disabled)" :
+                          " (was stopping)");
+            break;
+        case LifecycleEvent::Type::HEALTH_CHANGED:
+            if (event.health == ModuleHealth::UNHEALTHY) {
+                ELOG_WARN << "Module [" << name << "] with PID " << event.pid << " is unhealthy";
+            } else {
+                ELOG_INFO << "Module [" << name << "] with PID " << event.pid << " is "
+                          << (event.health == ModuleHealth::HEALTHY ? "healthy" : "in unknown health");
+            }
+            break;
+        case LifecycleEvent::Type::CONFIG_RELOADED:
+            if (event.error != 0) {
+                ELOG_ERROR << "Configuration reload failed (" << std::strerror(event.error)
+                           << "), keeping current configuration";
+            } else {
+                ELOG_INFO << "Configuration reloaded";
+            }
+            break;
+    }
+}
+
+std::shared_ptr<EventSubscription> ProcessManager::subscribe(size_t capacity) {
+    // 之后发布的事件才会进入新的订阅
+    return bus_.subscribe(capacity);
+}
+
+bool ProcessManager::reportHealth(const std::string& name, ModuleHealth health) {
+    return reportHealth(findModule(name), health);
+}
+
+bool ProcessManager::reportHealth(ModuleId id, ModuleHealth health) {
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        Module* module = modules_.get(id);
+        if (!module) {
+            return false;
+        }
+        if (module->info.health != health) {
+            module->info.health = health;
+            changedLocked(id);
+            LifecycleEvent changed = eventLocked(LifecycleEvent::Type::HEALTH_CHANGED, module->info);
+            changed.health = health;
+            emitLocked(changed);
+        }
+    }
+    drainEvents();
+    return true;
+}
+
+void ProcessManager::notifyConfigReloaded(int error) {
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        LifecycleEvent reloaded;
+        reloaded.type = LifecycleEvent::Type::CONFIG_RELOADED;
+        reloaded.seq = ++event_seq_;
+        reloaded.error = error;
+        emitLocked(reloaded);
+    }
+    drainEvents();
 }
 
 ProcessState ProcessManager::getModuleState(const std::string& name) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = processes_.find(name);
-    return it != processes_.end() ? it->second.state : ProcessState::STOPPED;
+    const ProcessInfo* info = snapshot()->find(name);
+    return info ? info->state : ProcessState::STOPPED;
+}
+
+ProcessState ProcessManager::getModuleState(ModuleId id) const {
+    const ProcessInfo* info = snapshot()->find(id);
+    return info ? info->state : ProcessState::STOPPED;
 }
 
 std::vector<ProcessInfo> ProcessManager::getAllProcesses() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<ProcessInfo> result;
+    return snapshot()->processes;
+}
+
+std::shared_ptr<const ProcessSnapshot> ProcessManager::snapshot() const {
+    snapshot_read_.store(true, std::memory_order_relaxed);
+    auto current = snapshot_.load(std::memory_order_acquire);
+    if (current && current->version == version_.load(std::memory_order_acquire)) {
+        return current;
+    }
+    return publish();
+}
+
+void ProcessManager::changedLocked(ModuleId id) {
+    if (!rebuild_ && id.valid()) {
+        // 没有读取者时dirty_不会被取走，超过模块数后改为完整重建
+        if (dirty_.size() < modules_.size()) {
+            dirty_.push_back(id);
+        } else {
+            rebuild_ = true;
+            dirty_.clear();
+        }
+    }
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const ProcessSnapshot> ProcessManager::publish() const {
+    std::lock_guard<std::mutex> publishing(publish_mutex_);
+    // 其他线程可能已经发布了当前版本
+    auto current = snapshot_.load(std::memory_order_acquire);
+    if (current && current->version == version_.load(std::memory_order_acquire)) {
+        return current;
+    }
+    
+    auto next = std::make_shared<ProcessSnapshot>();
+    std::vector<ProcessInfo> changed;
+    bool rebuild;
+    {
+        std::lock_guard<TimedMutex> lock(mutex_);
+        // 版本只在锁内改变
+        next->version = version_.load(std::memory_order_relaxed);
+        rebuild = rebuild_ || !current;
+        if (rebuild) {
+            next->processes.reserve(modules_.size());
+            for (const auto& module : modules_) {
+                next->processes.push_back(module.info);
+            }
+        } else {
+            changed.reserve(dirty_.size());
+            for (ModuleId id : dirty_) {
+                if (const Module* module = modules_.get(id)) {
+                    changed.push_back(module->info);
+                }
+            }
+        }
+        auto& copied = rebuild ? next->processes : changed;
+        if (trackingDescendants()) {
+            for (auto& info : copied) {
+                info.descendants = descendants_.count(info.name);
+            }
+        }
+        dirty_.clear();
+        rebuild_ = false;
+    }
     
-    for (const auto& [name, info] : processes_) {
-        result.push_back(info);
+    if (!rebuild) {
+        // 模块集合没有变化：索引不变，只替换变化的模块
+        next->processes = current->processes;
+        next->by_slot = current->by_slot;
+        next->by_name = current->by_name;
+        for (auto& info : changed) {
+            next->processes[next->by_slot[info.id.index]] = std::move(info);
+        }
+    } else {
+        uint32_t slots = 0;
+        for (const auto& info : next->processes) {
+            slots = std::max(slots, info.id.index + 1);
+        }
+        next->by_slot.assign(slots, UINT32_MAX);
+        next->by_name.resize(next->processes.size());
+        for (uint32_t i = 0; i < next->processes.size(); ++i) {
+            next->by_slot[next->processes[i].id.index] = i;
+            next->by_name[i] = i;
+        }
+        const auto& processes = next->processes;
+        std::sort(next->by_name.begin(), next->by_name.end(),
+                  [&processes](uint32_t a, uint32_t b) { return processes[a].name < processes[b].name; });
     }
     
-    return result;
+    std::shared_ptr<const ProcessSnapshot> published = std::move(next);
+    snapshot_.store(published, std::memory_order_release);
+    return published;
 }
 
-bool ProcessManager::isRunning(const std::string& name) const {
-    return getModuleState(name) == ProcessState::RUNNING;
+const ProcessInfo* ProcessSnapshot::find(ModuleId id) const {
+    if (id.index >= by_slot.size() || by_slot[id.index] == UINT32_MAX) {
+        return nullptr;
+    }
+    const ProcessInfo& info = processes[by_slot[id.index]];
+    return info.id == id ? &info : nullptr;
 }
 
-void ProcessManager::updateProcessState(const std::string& name, ProcessState state) {
-    auto it = processes_.find(name);
-    if (it != processes_.end()) {
-        it->second.state = state;
-    }
+const ProcessInfo* ProcessSnapshot::find(std::string_view name) const {
+    auto it = std::lower_bound(by_name.begin(), by_name.end(), name,
+                               [this](uint32_t i, std::string_view key) { return processes[i].name < key; });
+    return it != by_name.end() && processes[*it].name == name ? &processes[*it] : nullptr;
+}
+
+bool ProcessManager::isRunning(const std::string& name) const {
+    return getModuleState(name) == ProcessState::RUNNING;
 }
 
 } // namespace ProcessManager
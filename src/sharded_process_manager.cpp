@@ -0,0 +1,157 @@
+#include "process_manager/sharded_process_manager.h"
+#include "process_manager/signal_handler.h"
+#include <functional>
+#include <future>
+#include "ylt/easylog.hpp"
+
+namespace ProcessManager {
+
+ShardedProcessManager::ShardedProcessManager(size_t shard_count, SupervisorOptions options) {
+    if (shard_count == 0) {
+        shard_count = 1;
+    }
+    
+    // waitpid(-1)会回收其他分片的子进程，每个分片必须只回收自己的进程
+    options.mode = SupervisorMode::EVENT;
+    options.reap_owned_only = true;
+    
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        SupervisorOptions shard_options = options;
+        shard_options.handle_signals = options.handle_signals && i == 0;
+        auto shard = std::make_unique<Shard>();
+        shard->manager = std::make_unique<ProcessManager>(shard_options);
+        shards_.push_back(std::move(shard));
+    }
+    
+    for (auto& shard : shards_) {
+        Shard* raw = shard.get();
+        shard->thread = std::thread([this, raw] { run(*raw); });
+    }
+    ELOG_INFO << "Sharded process manager started with " << shard_count << " shards";
+}
+
+ShardedProcessManager::~ShardedProcessManager() {
+    shutdown();
+}
+
+void ShardedProcessManager::run(Shard& shard) {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        shard.manager->runOnce(-1);
+    }
+}
+
+size_t ShardedProcessManager::shardOf(const std::string& name) const {
+    return std::hash<std::string>{}(name) % shards_.size();
+}
+
+bool ShardedProcessManager::addModule(const std::string& name, const std::string& command, bool auto_restart,
+                                      const ModuleStdio& stdio, ShellMode shell) {
+    return shards_[shardOf(name)]->manager->addModule(name, command, auto_restart, stdio, shell);
+}
+
+bool ShardedProcessManager::addModuleArgv(const std::string& name, const CommandArgs& argv, bool auto_restart,
+                                          const ModuleStdio& stdio) {
+    return shards_[shardOf(name)]->manager->addModuleArgv(name, argv, auto_restart, stdio);
+}
+
+bool ShardedProcessManager::removeModule(const std::string& name) {
+    return shards_[shardOf(name)]->manager->removeModule(name);
+}
+
+bool ShardedProcessManager::startModule(const std::string& name) {
+    return shards_[shardOf(name)]->manager->startModule(name);
+}
+
+bool ShardedProcessManager::stopModule(const std::string& name) {
+    return shards_[shardOf(name)]->manager->stopModule(name);
+}
+
+bool ShardedProcessManager::restartModule(const std::string& name) {
+    return shards_[shardOf(name)]->manager->restartModule(name);
+}
+
+size_t ShardedProcessManager::startAll() {
+    std::vector<std::future<size_t>> results;
+    results.reserve(shards_.size());
+    
+    for (auto& shard : shards_) {
+        auto promise = std::make_shared<std::promise<size_t>>();
+        results.push_back(promise->get_future());
+        Shard* raw = shard.get();
+        raw->manager->post([this, raw, promise] {
+            size_t started = 0;
+            for (const auto& result : raw->manager->startAll()) {
+                started += result.started ? 1 : 0;
+            }
+            promise->set_value(started);
+        });
+    }
+    
+    size_t total = 0;
+    for (auto& result : results) {
+        total += result.get();
+    }
+    return total;
+}
+
+ProcessState ShardedProcessManager::getModuleState(const std::string& name) const {
+    auto snapshot = shards_[shardOf(name)]->manager->snapshot();
+    const ProcessInfo* info = snapshot->find(name);
+    return info ? info->state : ProcessState::STOPPED;
+}
+
+std::vector<ProcessInfo> ShardedProcessManager::getAllProcesses() const {
+    std::vector<std::shared_ptr<const ProcessSnapshot>> snapshots;
+    snapshots.reserve(shards_.size());
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        snapshots.push_back(shard->manager->snapshot());
+        total += snapshots.back()->processes.size();
+    }
+    
+    std::vector<ProcessInfo> result;
+    result.reserve(total);
+    for (const auto& snapshot : snapshots) {
+        result.insert(result.end(), snapshot->processes.begin(), snapshot->processes.end());
+    }
+    return result;
+}
+
+bool ShardedProcessManager::isRunning(const std::string& name) const {
+    return getModuleState(name) == ProcessState::RUNNING;
+}
+
+bool ShardedProcessManager::shouldExit() const {
+    return SignalHandler::shouldShutdown();
+}
+
+void ShardedProcessManager::shutdown() {
+    if (shut_down_) {
+        return;
+    }
+    shut_down_ = true;
+    
+    stopping_.store(true, std::memory_order_release);
+    for (auto& shard : shards_) {
+        shard->manager->post([] {});  // 唤醒阻塞在runOnce中的分片线程
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    
+    // 各分片的SIGTERM→SIGKILL等待并行进行
+    std::vector<std::thread> workers;
+    workers.reserve(shards_.size());
+    for (auto& shard : shards_) {
+        ProcessManager* manager = shard->manager.get();
+        workers.emplace_back([manager] { manager->shutdown(); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace ProcessManager
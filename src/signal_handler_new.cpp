@@ -1,5 +1,7 @@
 #include "process_manager/signal_handler.h"
 #include <signal.h>
+#include <sys/signalfd.h>
+#include <cerrno>
 #include <iostream>
 
 namespace ProcessManager {
@@ -13,6 +15,14 @@ void SignalHandler::setupShutdownHandler() {
     sa.sa_flags = SA_RESTART; // 自动重启被中断的系统调用
     sigaction(SIGINT, &sa, nullptr);
     sigaction(SIGTERM, &sa, nullptr);
+    
+    // blockSignals/createSignalFd可能已阻塞这两个信号（signalfd不可用时的退化路径），
+    // 阻塞中的信号不会调用处理器，管理器将无法停止
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
 }
 
 void SignalHandler::sigintHandler(int signo) {
@@ -25,8 +35,51 @@ bool SignalHandler::shouldShutdown() {
     return shutdown_requested_.load(std::memory_order_acquire);
 }
 
+void SignalHandler::requestShutdown() {
+    shutdown_requested_.store(true, std::memory_order_release);
+}
+
 void SignalHandler::resetShutdownFlag() {
     shutdown_requested_.store(false, std::memory_order_release);
 }
 
+void SignalHandler::managedSignals(sigset_t* set) {
+    sigemptyset(set);
+    sigaddset(set, SIGCHLD);
+    sigaddset(set, SIGTERM);
+    sigaddset(set, SIGINT);
+    sigaddset(set, SIGHUP);
+    sigaddset(set, SIGUSR1);
+    sigaddset(set, SIGUSR2);
+}
+
+bool SignalHandler::blockSignals() {
+    sigset_t set;
+    managedSignals(&set);
+    return pthread_sigmask(SIG_BLOCK, &set, nullptr) == 0;
+}
+
+int SignalHandler::createSignalFd() {
+    if (!blockSignals()) {
+        return -1;
+    }
+    sigset_t set;
+    managedSignals(&set);
+    return signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+int SignalHandler::readSignal(int fd) {
+    signalfd_siginfo info;
+    for (;;) {
+        ssize_t n = read(fd, &info, sizeof(info));
+        if (n == static_cast<ssize_t>(sizeof(info))) {
+            return static_cast<int>(info.ssi_signo);
+        }
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        return 0;
+    }
+}
+
 } // namespace ProcessManager
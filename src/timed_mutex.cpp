@@ -0,0 +1,51 @@
+#include "process_manager/timed_mutex.h"
+#include <algorithm>
+#include <bit>
+
+namespace ProcessManager {
+
+uint64_t LockStats::percentileNs(double p) const {
+    uint64_t target = static_cast<uint64_t>(p * acquisitions);
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen > target) {
+            return bucketUpperNs(i);
+        }
+    }
+    return max_ns;
+}
+
+void TimedMutex::record(Clock::duration held) {
+    // 在锁内调用：只更新原子计数器，统计的读取方不需要获取这把锁
+    uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(held).count());
+    int bucket = ns < 128 ? 0 : std::min<int>(std::bit_width(ns) - 7, LockStats::kBuckets - 1);
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > max_ns_.load(std::memory_order_relaxed)) {
+        max_ns_.store(ns, std::memory_order_relaxed);   // 只有持锁者写入，不需要CAS
+    }
+}
+
+LockStats TimedMutex::stats() const {
+    LockStats stats;
+    stats.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+    stats.total_ns = total_ns_.load(std::memory_order_relaxed);
+    stats.max_ns = max_ns_.load(std::memory_order_relaxed);
+    for (int i = 0; i < LockStats::kBuckets; ++i) {
+        stats.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void TimedMutex::resetStats() {
+    acquisitions_.store(0, std::memory_order_relaxed);
+    total_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace ProcessManager
@@ -0,0 +1,222 @@
+#include "process_manager/timer_wheel.h"
+#include <algorithm>
+#include <bit>
+#include <climits>
+
+namespace ProcessManager {
+
+namespace {
+constexpr uint64_t kSlotMask = 63;
+}
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point start)
+    : tick_(std::max(tick, std::chrono::milliseconds(1))), start_(start) {
+    for (auto& level : heads_) {
+        std::fill(std::begin(level), std::end(level), kNil);
+    }
+}
+
+uint64_t TimerWheel::toTick(Clock::time_point t) const {
+    if (t <= start_) {
+        return 0;
+    }
+    return static_cast<uint64_t>((t - start_) / tick_);
+}
+
+uint64_t TimerWheel::delayTicks(std::chrono::milliseconds delay) const {
+    if (delay.count() <= 0) {
+        return 0;
+    }
+    // 向上取整，保证不会早于请求的延迟触发
+    return static_cast<uint64_t>((delay.count() + tick_.count() - 1) / tick_.count());
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback) {
+    return add(delayTicks(delay), 0, std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::schedulePeriodic(std::chrono::milliseconds interval, Callback callback) {
+    uint64_t ticks = std::max<uint64_t>(delayTicks(interval), 1);
+    return add(ticks, ticks, std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::add(uint64_t delay_ticks, uint64_t interval, Callback callback) {
+    uint32_t index;
+    if (!free_list_.empty()) {
+        index = free_list_.back();
+        free_list_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    
+    Node& node = nodes_[index];
+    node.expiry = now_tick_ + delay_ticks;
+    node.interval = interval;
+    node.callback = std::move(callback);
+    link(index);
+    ++active_count_;
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (id == kInvalidTimer) {
+        return false;
+    }
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= nodes_.size() || nodes_[index].generation != generation || nodes_[index].level < 0) {
+        return false;   // 已触发或已取消
+    }
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::link(uint32_t index) {
+    Node& node = nodes_[index];
+    uint64_t expiry = node.expiry;
+    uint64_t diff = expiry > now_tick_ ? expiry - now_tick_ : 0;
+    
+    int level = 0;
+    while (level < kLevels - 1 && diff >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    if (level == kLevels - 1) {
+        // 超出时间轮范围的定时器放在最高层，降级时按真实到期时间重新放置
+        uint64_t max_span = (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+        expiry = now_tick_ + std::min(diff, max_span);
+    } else if (diff == 0) {
+        expiry = now_tick_;
+    }
+    int slot = static_cast<int>((expiry >> (kSlotBits * level)) & kSlotMask);
+    
+    node.level = static_cast<int16_t>(level);
+    node.slot = static_cast<int16_t>(slot);
+    node.prev = kNil;
+    node.next = heads_[level][slot];
+    if (node.next != kNil) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[level][slot] = index;
+    occupied_[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.level][node.slot] = node.next;
+        if (node.next == kNil) {
+            occupied_[node.level] &= ~(uint64_t(1) << node.slot);
+        }
+    }
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.prev = node.next = kNil;
+    node.level = node.slot = -1;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes_[index];
+    node.callback = nullptr;
+    node.generation++;
+    free_list_.push_back(index);
+    --active_count_;
+}
+
+void TimerWheel::cascade(int level) {
+    int slot = static_cast<int>((now_tick_ >> (kSlotBits * level)) & kSlotMask);
+    uint32_t index = heads_[level][slot];
+    heads_[level][slot] = kNil;
+    occupied_[level] &= ~(uint64_t(1) << slot);
+    
+    while (index != kNil) {
+        uint32_t next = nodes_[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+void TimerWheel::expireCurrent(std::vector<Callback>& due) {
+    int slot = static_cast<int>(now_tick_ & kSlotMask);
+    while (heads_[0][slot] != kNil) {
+        uint32_t index = heads_[0][slot];
+        unlink(index);
+        Node& node = nodes_[index];
+        if (node.interval > 0) {
+            due.push_back(node.callback);
+            node.expiry = now_tick_ + node.interval;
+            link(index);
+        } else {
+            due.push_back(std::move(node.callback));
+            release(index);
+        }
+    }
+}
+
+size_t TimerWheel::advance(Clock::time_point now, std::vector<Callback>& due) {
+    size_t before = due.size();
+    uint64_t target = toTick(now);
+    
+    expireCurrent(due);
+    while (now_tick_ < target) {
+        if (active_count_ == 0) {
+            now_tick_ = target;
+            break;
+        }
+        ++now_tick_;
+        if ((now_tick_ & kSlotMask) == 0) {
+            // 自上而下降级，保证高层的定时器先落入低层再被处理
+            int top = 1;
+            while (top < kLevels - 1 && ((now_tick_ >> (kSlotBits * top)) & kSlotMask) == 0) {
+                ++top;
+            }
+            for (int level = top; level >= 1; --level) {
+                cascade(level);
+            }
+        }
+        expireCurrent(due);
+    }
+    return due.size() - before;
+}
+
+int TimerWheel::nextTimeoutMs(Clock::time_point now) const {
+    if (active_count_ == 0) {
+        return -1;
+    }
+    
+    uint64_t next_tick = UINT64_MAX;
+    
+    // 第0层：最近的非空槽位即最近的到期时间
+    if (occupied_[0]) {
+        int current = static_cast<int>(now_tick_ & kSlotMask);
+        uint64_t rotated = std::rotr(occupied_[0], current);
+        next_tick = now_tick_ + static_cast<uint64_t>(std::countr_zero(rotated));
+    }
+    
+    // 高层：最近的非空槽位被降级的时刻
+    for (int level = 1; level < kLevels; ++level) {
+        if (!occupied_[level]) {
+            continue;
+        }
+        int shift = kSlotBits * level;
+        int current = static_cast<int>((now_tick_ >> shift) & kSlotMask);
+        uint64_t rotated = std::rotr(occupied_[level], current);
+        uint64_t ahead = rotated & ~uint64_t(1);
+        uint64_t offset = ahead ? static_cast<uint64_t>(std::countr_zero(ahead)) : kSlots;
+        uint64_t tick = ((now_tick_ >> shift) + offset) << shift;
+        next_tick = std::min(next_tick, tick);
+    }
+    
+    auto deadline = start_ + tick_ * static_cast<int64_t>(next_tick);
+    if (deadline <= now) {
+        return 0;
+    }
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+    return static_cast<int>(std::min<int64_t>(ms, INT_MAX));
+}
+
+} // namespace ProcessManager
@@ -0,0 +1,263 @@
+#include "process_manager/zygote.h"
+#include "process_manager/process_launcher.h"
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <vector>
+
+namespace ProcessManager {
+
+namespace {
+
+constexpr int kSocketFd = 3;        // zygote中socket和cgroup fd的固定编号
+constexpr int kCgroupFd = 4;
+constexpr size_t kMaxRequestSize = 1 << 20;
+constexpr size_t kMaxPassedFds = 16;
+
+struct Reply {
+    int32_t pid;
+    int32_t error;
+};
+
+// 把fd移动到固定编号并设置CLOEXEC
+bool moveFd(int fd, int target) {
+    if (fd == target) {
+        return fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+    }
+    return dup3(fd, target, O_CLOEXEC) == target;
+}
+
+void closeFrom(int first) {
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, first, ~0U, 0) == 0) {
+        return;
+    }
+#endif
+    long max_fd = sysconf(_SC_OPEN_MAX);
+    for (long fd = first; fd < (max_fd > 0 ? max_fd : 1024); ++fd) {
+        close(static_cast<int>(fd));
+    }
+}
+
+ssize_t sendWithFds(int sock, const void* data, size_t size, const int* fds, size_t fd_count) {
+    iovec iov{const_cast<void*>(data), size};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxPassedFds)];
+    if (fd_count > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    }
+    
+    ssize_t ret;
+    do {
+        ret = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+ssize_t recvWithFds(int sock, void* data, size_t size, int* fds, size_t* fd_count) {
+    iovec iov{data, size};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxPassedFds)];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    
+    ssize_t ret;
+    do {
+        ret = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (ret == -1 && errno == EINTR);
+    
+    *fd_count = 0;
+    if (ret > 0) {
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                std::memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * n);
+                *fd_count = n;
+            }
+        }
+    }
+    return ret;
+}
+
+} // namespace
+
+Zygote::~Zygote() {
+    stop();
+}
+
+bool Zygote::start(int cgroup_fd, bool new_process_group) {
+    if (sock_ != -1) {
+        return true;
+    }
+    
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) == -1) {
+        return false;
+    }
+    
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(sv[0]);
+        serve(sv[1], cgroup_fd, new_process_group);
+    }
+    
+    close(sv[1]);
+    sock_ = sv[0];
+    pid_ = pid;
+    return true;
+}
+
+void Zygote::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sock_ == -1) {
+        return;
+    }
+    // zygote读到EOF后自行退出
+    close(sock_);
+    sock_ = -1;
+    waitpid(pid_, nullptr, 0);
+    pid_ = -1;
+}
+
+void Zygote::serve(int sock, int cgroup_fd, bool new_process_group) {
+    // 只保留stdio、socket和cgroup fd，不持有管理器的epoll、signalfd、日志文件等
+    int high_sock = fcntl(sock, F_DUPFD_CLOEXEC, 64);
+    int high_cgroup = cgroup_fd >= 0 ? fcntl(cgroup_fd, F_DUPFD_CLOEXEC, 64) : -1;
+    if (high_sock == -1 || !moveFd(high_sock, kSocketFd) ||
+        (high_cgroup != -1 && !moveFd(high_cgroup, kCgroupFd))) {
+        _exit(1);
+    }
+    closeFrom(high_cgroup != -1 ? kCgroupFd + 1 : kSocketFd + 1);
+    
+    // 管理器退出时随之退出；信号掩码沿用管理器的（终端的SIGINT不会打断zygote）
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    prctl(PR_SET_NAME, "pm-zygote");
+    malloc_trim(0);
+    
+    LaunchOptions options;
+    // 不带cgroup时用vfork，连zygote自己的页表也不复制
+    options.backend = high_cgroup != -1 ? LaunchBackend::CLONE3 : LaunchBackend::VFORK;
+    options.clone_parent = true;
+    options.cgroup_fd = high_cgroup != -1 ? kCgroupFd : -1;
+    options.new_process_group = new_process_group;
+    
+    std::vector<char> request(kMaxRequestSize);
+    int fds[kMaxPassedFds];
+    for (;;) {
+        size_t fd_count = 0;
+        ssize_t n = recvWithFds(kSocketFd, request.data(), request.size(), fds, &fd_count);
+        if (n <= 0) {
+            _exit(0);   // 管理器关闭了socket
+        }
+        
+        Reply reply{-1, 0};
+        int pidfd = -1;
+        auto plan = LaunchPlan::fromWire(request.data(), static_cast<size_t>(n), fds, fd_count);
+        if (!plan) {
+            reply.error = EINVAL;
+        } else if (auto pid = ProcessLauncher::launch(*plan, options, &pidfd)) {
+            reply.pid = *pid;
+        } else {
+            reply.error = errno;
+        }
+        // exec失败时pidfd仍然有效：子进程属于管理器，由它通过pidfd回收
+        sendWithFds(kSocketFd, &reply, sizeof(reply), &pidfd, pidfd != -1 ? 1 : 0);
+        if (pidfd != -1) {
+            close(pidfd);
+        }
+        for (size_t i = 0; i < fd_count; ++i) {
+            close(fds[i]);
+        }
+    }
+}
+
+std::optional<pid_t> Zygote::launch(const LaunchPlan& plan, int* pidfd) {
+    if (pidfd) {
+        *pidfd = -1;
+    }
+    
+    int source_fds[kMaxPassedFds];
+    size_t source_count = 0;
+    for (const auto& action : plan.fdActions()) {
+        if (action.type == FdAction::DUP2) {
+            if (source_count == kMaxPassedFds) {
+                errno = E2BIG;
+                return std::nullopt;
+            }
+            source_fds[source_count++] = action.source;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sock_ == -1) {
+        errno = EPIPE;
+        return std::nullopt;
+    }
+    
+    const std::string& wire = plan.wire();
+    Reply reply{};
+    int fd = -1;
+    size_t fd_count = 0;
+    // 失败时保留真实的errno：只有连接断开才意味着zygote已退出
+    if (sendWithFds(sock_, wire.data(), wire.size(), source_fds, source_count) == -1) {
+        return std::nullopt;
+    }
+    ssize_t received = recvWithFds(sock_, &reply, sizeof(reply), &fd, &fd_count);
+    if (fd_count == 0) {
+        fd = -1;
+    }
+    if (received != static_cast<ssize_t>(sizeof(reply))) {
+        if (fd != -1) {
+            close(fd);
+        }
+        if (received == 0) {
+            errno = EPIPE;      // 对端关闭
+        } else if (received > 0) {
+            errno = EPROTO;
+        }
+        return std::nullopt;
+    }
+    
+    if (reply.error != 0) {
+        if (fd != -1) {
+            // CLONE_PARENT创建的子进程是管理器的子进程，exec失败后在这里回收
+            siginfo_t info;
+            waitid(static_cast<idtype_t>(3 /* P_PIDFD */), static_cast<id_t>(fd), &info, WEXITED);
+            close(fd);
+        }
+        errno = reply.error;
+        return std::nullopt;
+    }
+    
+    if (pidfd) {
+        *pidfd = fd;
+    } else if (fd != -1) {
+        close(fd);
+    }
+    return reply.pid;
+}
+
+} // namespace ProcessManager
@@ -0,0 +1,128 @@
+// CommandParser::compile支持的shell子集：解释器的结果与bash一致，超出子集的语法退回bash
+#include "process_manager/command_parser.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using ProcessManager::CommandArgs;
+using ProcessManager::CommandParser;
+using ProcessManager::ShellCommand;
+using ProcessManager::ShellMode;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                         \
+        }                                                                       \
+    } while (0)
+
+bool fallsBack(const std::string& line) {
+    ShellCommand command = CommandParser::compile(line);
+    return !command.interpreted && command.args == CommandArgs{"/bin/bash", "-c", line};
+}
+
+bool interpretsTo(const std::string& line, const CommandArgs& args) {
+    ShellCommand command = CommandParser::compile(line);
+    return command.interpreted && command.args == args;
+}
+
+void testEmpty() {
+    for (const char* line : {"", "   ", "\t\n", "# only a comment", " ; "}) {
+        ShellCommand command = CommandParser::compile(line);
+        CHECK(command.args.empty());
+        CHECK(!CommandParser::validateCommand(command.args));
+        CHECK(CommandParser::compile(line, ShellMode::ALWAYS).args.empty());
+    }
+}
+
+void testPlainWords() {
+    CHECK(interpretsTo("sleep 10", {"sleep", "10"}));
+    CHECK(interpretsTo("echo 'a b' \"c d\" e\\ f", {"echo", "a b", "c d", "e f"}));
+    CHECK(interpretsTo("echo \"\" x", {"echo", "", "x"}));
+}
+
+void testExpansions() {
+    setenv("HOME", "/home/test", 1);
+    setenv("GREETING", "hello world", 1);
+    CHECK(interpretsTo("echo ~ ~/x", {"echo", "/home/test", "/home/test/x"}));
+    CHECK(interpretsTo("echo $GREETING", {"echo", "hello", "world"}));
+    CHECK(interpretsTo("echo \"$GREETING\" ${GREETING}!", {"echo", "hello world", "hello", "world!"}));
+    CHECK(interpretsTo("echo \"~\" '~' \\~", {"echo", "~", "~", "~"}));
+    CHECK(interpretsTo("echo \"$'x\" \"$\\\"y\"", {"echo", "$'x", "$\"y"}));
+    CHECK(interpretsTo("echo '{a,b}' \"{a,b}\"", {"echo", "{a,b}", "{a,b}"}));
+}
+
+void testUnsupportedFallsBack() {
+    // bash会展开而解释器不支持的语法
+    CHECK(fallsBack("echo {a,b}"));
+    CHECK(fallsBack("echo x{1..3}"));
+    CHECK(fallsBack("echo ~root/x"));
+    CHECK(fallsBack("echo a:~/x"));
+    CHECK(fallsBack("echo $'a\\tb'"));
+    CHECK(fallsBack("echo $\"hi\""));
+    CHECK(fallsBack("A=~/x prog"));
+    CHECK(fallsBack("PATH=$PATH:~/bin prog"));
+    CHECK(fallsBack("export A=~/x && prog"));
+    CHECK(fallsBack("prog > ~/log"));
+    CHECK(fallsBack("echo *.txt"));
+    CHECK(fallsBack("a | b"));
+    CHECK(fallsBack("prog &"));
+    CHECK(fallsBack("echo $(date)"));
+    CHECK(fallsBack("echo $1"));
+    CHECK(CommandParser::compile("a | b", ShellMode::NEVER).args.empty());
+}
+
+void testBuiltinsAndRedirects() {
+    ShellCommand command = CommandParser::compile("cd /tmp/a/../b && FOO=bar exec prog arg > out 2>&1");
+    CHECK(command.interpreted);
+    CHECK(command.args == (CommandArgs{"prog", "arg"}));
+    CHECK(command.cwd == "/tmp/b");
+    bool has_foo = false;
+    for (const auto& entry : command.env) {
+        has_foo = has_foo || entry == "FOO=bar";
+    }
+    CHECK(has_foo);
+    CHECK(command.redirects.size() == 2);
+    if (command.redirects.size() == 2) {
+        CHECK(command.redirects[0].target == 1 && command.redirects[0].path == "out");
+        CHECK(command.redirects[1].target == 2 && command.redirects[1].source == 1);
+    }
+}
+
+void testNeedsShell() {
+    CHECK(!CommandParser::needsShell("sleep 10"));
+    CHECK(CommandParser::needsShell("echo {a,b}"));
+    CHECK(CommandParser::needsShell("echo ~root"));
+    CHECK(CommandParser::needsShell("A=~/x prog"));
+    CHECK(CommandParser::needsShell("cd /tmp"));
+    // 不收集词的判定与scan一致：引号拼接的命令名、长变量名的赋值、长命令名
+    for (const char* line : {"'cd' /tmp", "c\\d /tmp", "\"ex\"port A=1", "A_VERY_LONG_VARIABLE_NAME_X=1 prog",
+                             "A_VERY_LONG_VARIABLE_NAME_X prog", "/opt/app/bin/a-rather-long-server --x=1",
+                             "'prog name' a=b", "=x prog", "1A=x prog", "echo A=1"}) {
+        CHECK(CommandParser::needsShell(line) == CommandParser::scan(line).needs_shell);
+    }
+    CHECK(CommandParser::needsShell("A_VERY_LONG_VARIABLE_NAME_X=1 prog"));
+    CHECK(!CommandParser::needsShell("/opt/app/bin/a-rather-long-server --x=1"));
+}
+
+} // namespace
+
+int main() {
+    testEmpty();
+    testPlainWords();
+    testExpansions();
+    testUnsupportedFallsBack();
+    testBuiltinsAndRedirects();
+    testNeedsShell();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("command_parser_test: all checks passed\n");
+    return 0;
+}